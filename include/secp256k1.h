@@ -5,6 +5,7 @@
 extern "C" {
 # endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 # if !defined(SECP256K1_GNUC_PREREQ)
@@ -54,6 +55,14 @@ typedef struct secp256k1_context_struct secp256k1_context_t;
 # define SECP256K1_CONTEXT_SIGN   (1 << 1)
 # define SECP256K1_CONTEXT_COMMIT (1 << 7)
 # define SECP256K1_CONTEXT_RANGEPROOF (1 << 8)
+/** Back the precomputed tables with huge pages where the system provides them; see
+ *  secp256k1_context_tables_mode. Clones inherit this. */
+# define SECP256K1_CONTEXT_HUGEPAGES (1 << 9)
+
+/** The memory backing a context's precomputed tables, as reported by secp256k1_context_tables_mode. */
+# define SECP256K1_TABLES_DEFAULT 0 /* ordinary pages */
+# define SECP256K1_TABLES_THP     1 /* transparent huge pages, requested with madvise(MADV_HUGEPAGE) */
+# define SECP256K1_TABLES_HUGETLB 2 /* explicitly reserved hugetlb pages */
 
 /** Create a secp256k1 context object.
  *  Returns: a newly created context object.
@@ -72,12 +81,114 @@ secp256k1_context_t* secp256k1_context_clone(
 ) SECP256K1_WARN_UNUSED_RESULT;
 
 /** Destroy a secp256k1 context object.
- *  The context pointer may not be used afterwards.
+ *  The context pointer may not be used afterwards. Contexts made by the
+ *  preallocated functions below must use secp256k1_context_preallocated_destroy.
  */
 void secp256k1_context_destroy(
   secp256k1_context_t* ctx
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Determine the memory secp256k1_context_preallocated_create needs.
+ *  Returns: the number of bytes for a context with these flags, including all
+ *           its precomputed tables.
+ *  In:      flags: which parts of the context to initialize.
+ */
+size_t secp256k1_context_preallocated_size(
+  int flags
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Create a secp256k1 context object in caller-provided memory.
+ *  Returns: a context object inside prealloc (not necessarily at its start).
+ *  In:      prealloc: secp256k1_context_preallocated_size(flags) bytes, aligned
+ *                     like malloc's result. The tables come first, so 64-byte
+ *                     alignment keeps every entry on one cache line and a
+ *                     2 MiB-aligned buffer lets huge pages back it.
+ *           flags: which parts of the context to initialize.
+ *                  SECP256K1_CONTEXT_HUGEPAGES is ignored.
+ *  Neither this nor the other preallocated functions allocate memory or abort.
+ *  The memory must stay valid, and must not be used for anything else, until
+ *  the context is passed to secp256k1_context_preallocated_destroy.
+ */
+secp256k1_context_t* secp256k1_context_preallocated_create(
+  void* prealloc,
+  int flags
+) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Determine the memory secp256k1_context_preallocated_clone needs for a copy of ctx.
+ *  Returns: the number of bytes.
+ *  In:      ctx: an existing context to copy
+ */
+size_t secp256k1_context_preallocated_clone_size(
+  const secp256k1_context_t* ctx
+) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Copy a secp256k1 context object into caller-provided memory.
+ *  Returns: a context object inside prealloc.
+ *  In:      ctx: an existing context to copy (created either way)
+ *           prealloc: secp256k1_context_preallocated_clone_size(ctx) bytes,
+ *                     with the same requirements as for
+ *                     secp256k1_context_preallocated_create.
+ */
+secp256k1_context_t* secp256k1_context_preallocated_clone(
+  const secp256k1_context_t* ctx,
+  void* prealloc
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Destroy a context made by secp256k1_context_preallocated_create or _clone.
+ *  It does not free the memory; that is up to the caller afterwards.
+ */
+void secp256k1_context_preallocated_destroy(
+  secp256k1_context_t* ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** Opaque data structure that holds memory for the large temporaries of some functions
+ *  (the *_scratch variants), so they need only a small stack. It is a bump
+ *  allocator: a function draws what it needs and returns it before it returns.
+ *  A scratch space must not be used by two functions at the same time.
+ */
+typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space_t;
+
+/** Create a scratch space.
+ *  Returns: a newly created scratch space.
+ *  In:      size: the number of bytes it hands out at most.
+ */
+secp256k1_scratch_space_t* secp256k1_scratch_space_create(
+  size_t size
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Destroy a scratch space. The pointer may not be used afterwards. */
+void secp256k1_scratch_space_destroy(
+  secp256k1_scratch_space_t* scratch
+) SECP256K1_ARG_NONNULL(1);
+
+/** Remember how much of a scratch space is in use.
+ *  Returns: a checkpoint for secp256k1_scratch_space_reset.
+ *  In:      scratch: an existing scratch space
+ */
+size_t secp256k1_scratch_space_checkpoint(
+  const secp256k1_scratch_space_t* scratch
+) SECP256K1_ARG_NONNULL(1);
+
+/** Release everything a scratch space handed out since checkpoint was taken.
+ *  In:      scratch: an existing scratch space
+ *           checkpoint: a value secp256k1_scratch_space_checkpoint returned for it
+ *                       that has not been released already
+ */
+void secp256k1_scratch_space_reset(
+  secp256k1_scratch_space_t* scratch,
+  size_t checkpoint
+) SECP256K1_ARG_NONNULL(1);
+
+/** Report which kind of memory holds the precomputed tables of a context.
+ *  Returns: one of SECP256K1_TABLES_DEFAULT, SECP256K1_TABLES_THP or SECP256K1_TABLES_HUGETLB. The
+ *           latter two only occur for contexts created with SECP256K1_CONTEXT_HUGEPAGES. With THP the
+ *           kernel was asked for huge pages; whether it grants them depends on its configuration.
+ *  In:      ctx: an existing context
+ */
+int secp256k1_context_tables_mode(
+  const secp256k1_context_t* ctx
+) SECP256K1_ARG_NONNULL(1);
+
 /** Verify an ECDSA signature.
  *  Returns: 1: correct signature
  *           0: incorrect signature
@@ -178,6 +289,102 @@ int secp256k1_ecdsa_sign(
   const void *ndata
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
 
+/** Create n ECDSA signatures at once, each identical to what secp256k1_ecdsa_sign would produce.
+ *  Returns: 1: all signatures created
+ *           0: at least one could not be created; its siglen is set to zero, and the others
+ *              are still created.
+ *  In:      ctx:    pointer to a context object, initialized for signing (cannot be NULL)
+ *           msg32:  pointer to n pointers to the 32-byte message hashes being signed
+ *           seckey: pointer to n pointers to 32-byte secret keys
+ *           n:      the number of signatures to create (msg32, sig, siglen and seckey can be NULL if 0)
+ *           noncefp:pointer to a nonce generation function. If NULL, secp256k1_nonce_function_default is used
+ *           ndata:  pointer to arbitrary data used by the nonce generation function for every signature (can be NULL)
+ *  Out:     sig:    pointer to n pointers to arrays where the signatures will be placed
+ *  In/Out:  siglen: pointer to an array of n ints with the lengths of the sig arrays, which will be
+ *                   updated to contain the actual signature lengths (<=72).
+ *
+ *  Signing in a batch saves most of the inversions: the affine conversions of all R points share one
+ *  constant-time field inversion, and the nonces share one blinded, constant-time scalar inversion.
+ */
+int secp256k1_ecdsa_sign_batch(
+  const secp256k1_context_t* ctx,
+  const unsigned char * const *msg32,
+  unsigned char * const *sig,
+  int *siglen,
+  const unsigned char * const *seckey,
+  size_t n,
+  secp256k1_nonce_function_t noncefp,
+  const void *ndata
+) SECP256K1_ARG_NONNULL(1);
+
+/** Opaque data structure holding precomputed signing nonces: each entry is a secret nonce k, kept
+ *  as its inverse, with the r value of its point k*G. Entries are independent of the key and the
+ *  message, so filling the pool (the costly part) can happen ahead of time, and signing with
+ *  secp256k1_ecdsa_sign_with_pool takes only a few scalar operations. Every entry is used once,
+ *  and its memory is cleared as soon as it is taken. All functions on a pool may be called from
+ *  different threads at once.
+ */
+typedef struct secp256k1_presig_pool_struct secp256k1_presig_pool_t;
+
+/** Create an empty presignature pool.
+ *  Returns: a newly created pool.
+ *  In:      capacity: the most entries the pool holds (cannot be 0)
+ *           seed32:   32 bytes of fresh secret randomness that the nonces are derived from (cannot be NULL).
+ *                     Nonces are not derived from keys or messages, so the signatures are only as
+ *                     safe as this randomness is unpredictable and never reused.
+ */
+secp256k1_presig_pool_t* secp256k1_presig_pool_create(
+  size_t capacity,
+  const unsigned char *seed32
+) SECP256K1_ARG_NONNULL(2) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Destroy a pool, clearing the entries it still holds. The pointer may not be used afterwards. */
+void secp256k1_presig_pool_destroy(
+  secp256k1_presig_pool_t* pool
+) SECP256K1_ARG_NONNULL(1);
+
+/** Fill a pool up to its capacity, for example from an idle thread.
+ *  Returns: the number of entries added.
+ *  In:      ctx:    pointer to a context object, initialized for signing (cannot be NULL)
+ *           seed32: 32 bytes of fresh randomness to mix into the nonce derivation first (can be NULL)
+ *  In/Out:  pool:   the pool (cannot be NULL)
+ *  The pool stays usable while it is filled: entries are added in groups of up to 32, which
+ *  share their inversions as in secp256k1_ecdsa_sign_batch.
+ */
+size_t secp256k1_presig_pool_refill(
+  const secp256k1_context_t* ctx,
+  secp256k1_presig_pool_t* pool,
+  const unsigned char *seed32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Get the number of entries a pool holds. */
+size_t secp256k1_presig_pool_size(
+  secp256k1_presig_pool_t* pool
+) SECP256K1_ARG_NONNULL(1);
+
+/** Create an ECDSA signature, like secp256k1_ecdsa_sign, with a nonce taken from a pool.
+ *  Returns: 1: signature created
+ *           0: the pool was empty, the private key was invalid, or there is not enough space
+ *              in the signature (as indicated by siglen).
+ *  In:      ctx:    pointer to a context object (cannot be NULL)
+ *           msg32:  the 32-byte message hash being signed (cannot be NULL)
+ *           seckey: pointer to a 32-byte secret key (cannot be NULL)
+ *  In/Out:  pool:   the pool the nonce is taken from (cannot be NULL)
+ *  Out:     sig:    pointer to an array where the signature will be placed (cannot be NULL)
+ *  In/Out:  siglen: pointer to an int with the length of sig, which will be updated
+ *                   to contain the actual signature length (<=72).
+ *  The signature is in lower-S form, but its nonce does not come from a nonce function, so it
+ *  differs from the one secp256k1_ecdsa_sign would create.
+ */
+int secp256k1_ecdsa_sign_with_pool(
+  const secp256k1_context_t* ctx,
+  secp256k1_presig_pool_t* pool,
+  const unsigned char *msg32,
+  unsigned char *sig,
+  int *siglen,
+  const unsigned char *seckey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
 /** Create a compact ECDSA signature (64 byte + recovery id).
  *  Returns: 1: signature created
  *           0: the nonce generation function failed, or the secret key was invalid.
@@ -470,6 +677,50 @@ SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_rewind(
  int plen
 )SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7) SECP256K1_ARG_NONNULL(8) SECP256K1_ARG_NONNULL(9) SECP256K1_ARG_NONNULL(10);
 
+/** Estimate the cost of verifying a range proof from its header alone.
+ *  Returns 1: Header decoded and plen is exactly the length the verifier requires.
+ *          0: Header decode failed or the proof has the wrong length.
+ *  In:   ctx: pointer to a context object (cannot be NULL)
+ *        proof: pointer to character array with the proof. (cannot be NULL)
+ *        plen: length of proof in bytes.
+ *  Out:  rings: number of rings (digits) in the proof. (cannot be NULL)
+ *        npub: total number of public keys across all rings. (cannot be NULL)
+ *        ecmults: number of ecmult operations the verifier will perform. (cannot be NULL)
+ *        explen: exact proof length in bytes the verifier will accept. (cannot be NULL)
+ *
+ *  No elliptic curve operations are performed. When the header decodes, the outputs are set even if 0 is returned
+ *  because plen does not match explen.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_verify_cost(
+ const secp256k1_context_t* ctx,
+ int *rings,
+ int *npub,
+ int *ecmults,
+ int *explen,
+ const unsigned char *proof,
+ int plen
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+/** Cheaply check whether a range proof could be rewound with a given nonce, without verifying it.
+ *  Returns 1: The proof may have been created with nonce; secp256k1_rangeproof_rewind should be used to confirm and recover it.
+ *          0: The proof was not created with nonce, or is malformed.
+ *  In:   ctx: pointer to a context object (cannot be NULL)
+ *        nonce: 32-byte secret nonce used by the prover (cannot be NULL)
+ *        commit: the 33-byte commitment being proved. (cannot be NULL)
+ *        proof: pointer to character array with the proof. (cannot be NULL)
+ *        plen: length of proof in bytes.
+ *
+ *  This performs no elliptic curve operations, making it suitable for scanning many foreign proofs.
+ *  Proofs which reveal their value (exp of -1) carry no value encoding and always return 1.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_rewind_check(
+ const secp256k1_context_t* ctx,
+ const unsigned char *nonce,
+ const unsigned char *commit,
+ const unsigned char *proof,
+ int plen
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Author a proof that a committed value is within a range.
  *  Returns 1: Proof successfully created.
  *          0: Error
@@ -505,6 +756,24 @@ SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_sign(
  uint64_t value
 )SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7);
 
+/** Author a range proof using the compact header encoding.
+ *  Identical to secp256k1_rangeproof_sign, except that a non-zero min_value is encoded as a 1 to 10 byte varint
+ *  instead of a fixed 8 bytes, saving up to 7 bytes per proof for typical minimum values. The compact encoding is
+ *  flagged in the header, so secp256k1_rangeproof_verify accepts both formats; verifiers predating this format reject it.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_sign_compact(
+ const secp256k1_context_t* ctx,
+ unsigned char *proof,
+ int *plen,
+ uint64_t min_value,
+ const unsigned char *commit,
+ const unsigned char *blind,
+ const unsigned char *nonce,
+ int exp,
+ int min_bits,
+ uint64_t value
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7);
+
 /** Extract some basic information from a range-proof.
  *  Returns 1: Information successfully extracted.
  *          0: Decode failed.
@@ -526,6 +795,279 @@ SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_info(
  int plen
 )SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
 
+/** Determine the scratch space one range proof sign, verify or rewind draws.
+ *  Returns: the number of bytes; a scratch space with at least this many free
+ *           bytes never makes the *_scratch functions fail for lack of memory.
+ *  In:      ctx: pointer to a context object
+ */
+size_t secp256k1_rangeproof_scratch_size(
+ const secp256k1_context_t* ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** Like secp256k1_rangeproof_verify, but the proof's temporaries come from scratch.
+ *  Returns 0 as well if scratch has too little free space.
+ *  In:   scratch: scratch space with secp256k1_rangeproof_scratch_size bytes free (cannot be NULL)
+ *  All other arguments are as for secp256k1_rangeproof_verify.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_verify_scratch(
+ const secp256k1_context_t* ctx,
+ secp256k1_scratch_space_t* scratch,
+ uint64_t *min_value,
+ uint64_t *max_value,
+ const unsigned char *commit,
+ const unsigned char *proof,
+ int plen
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+/** Like secp256k1_rangeproof_rewind, but the proof's temporaries come from scratch.
+ *  Returns 0 as well if scratch has too little free space.
+ *  In:   scratch: scratch space with secp256k1_rangeproof_scratch_size bytes free (cannot be NULL)
+ *  All other arguments are as for secp256k1_rangeproof_rewind.
+ *  The memory drawn from scratch is zeroed before it is given back, as it held secrets.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_rewind_scratch(
+ const secp256k1_context_t* ctx,
+ secp256k1_scratch_space_t* scratch,
+ unsigned char *blind_out,
+ uint64_t *value_out,
+ unsigned char *message_out,
+ int *outlen,
+ const unsigned char *nonce,
+ uint64_t *min_value,
+ uint64_t *max_value,
+ const unsigned char *commit,
+ const unsigned char *proof,
+ int plen
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(7) SECP256K1_ARG_NONNULL(8) SECP256K1_ARG_NONNULL(9) SECP256K1_ARG_NONNULL(10) SECP256K1_ARG_NONNULL(11);
+
+/** Like secp256k1_rangeproof_sign, but the proof's temporaries come from scratch.
+ *  Returns 0 as well if scratch has too little free space.
+ *  In:   scratch: scratch space with secp256k1_rangeproof_scratch_size bytes free (cannot be NULL)
+ *        compact: non-zero to use the header encoding of secp256k1_rangeproof_sign_compact.
+ *  All other arguments are as for secp256k1_rangeproof_sign.
+ *  As for secp256k1_rangeproof_rewind_scratch, the memory used is zeroed before it is given back.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_sign_scratch(
+ const secp256k1_context_t* ctx,
+ secp256k1_scratch_space_t* scratch,
+ unsigned char *proof,
+ int *plen,
+ uint64_t min_value,
+ const unsigned char *commit,
+ const unsigned char *blind,
+ const unsigned char *nonce,
+ int exp,
+ int min_bits,
+ uint64_t value,
+ int compact
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7) SECP256K1_ARG_NONNULL(8);
+
+/** The kinds of item secp256k1_verify_batch_parallel can check. */
+# define SECP256K1_VERIFY_JOB_ECDSA      1 /* as secp256k1_ecdsa_verify; needs SECP256K1_CONTEXT_VERIFY */
+# define SECP256K1_VERIFY_JOB_RANGEPROOF 2 /* as secp256k1_rangeproof_verify */
+# define SECP256K1_VERIFY_JOB_TALLY      3 /* as secp256k1_pedersen_verify_tally; needs SECP256K1_CONTEXT_COMMIT */
+
+/** One item of a parallel batch verification. Set type and the matching member of u; the
+ *  fields of each member mean what the arguments of the same name mean for the single-item
+ *  function. result receives what that function would have returned, and a range proof
+ *  job also receives min_value and max_value.
+ */
+typedef struct {
+  int type;
+  int result;
+  void *reserved; /* used by the library while the job is queued */
+  union {
+    struct {
+      const unsigned char *msg32;
+      const unsigned char *sig;
+      int siglen;
+      const unsigned char *pubkey;
+      int pubkeylen;
+    } ecdsa;
+    struct {
+      const unsigned char *commit;
+      const unsigned char *proof;
+      int plen;
+      uint64_t min_value;
+      uint64_t max_value;
+    } rangeproof;
+    struct {
+      const unsigned char * const *commits;
+      int pcnt;
+      const unsigned char * const *ncommits;
+      int ncnt;
+      int64_t excess;
+    } tally;
+  } u;
+} secp256k1_verify_job_t;
+
+/** The body of one worker of a parallel computation: run by an executor as task(arg, worker). */
+typedef void (*secp256k1_parallel_task_t)(
+  void *arg,
+  int worker
+);
+
+/** A pointer to a function that runs parallel work on threads the caller owns.
+ *  In:      task:     the function to run (will not be NULL)
+ *           arg:      its first argument
+ *           nworkers: how many times to run it; call task(arg, i) once for every i in [0, nworkers)
+ *           data:     arbitrary data pointer that is passed through.
+ *  The calls may happen on any threads, in any order, and need not be concurrent: a worker
+ *  that runs out of work takes over the work of those that have not started. The function
+ *  must not return before all of the calls have returned.
+ */
+typedef void (*secp256k1_executor_function_t)(
+  secp256k1_parallel_task_t task,
+  void *arg,
+  int nworkers,
+  void *data
+);
+
+/** Check many signatures, range proofs and tallies on several threads.
+ *  Returns: 1 if every job's result is 1, 0 otherwise.
+ *  In:      ctx:      pointer to a context object, initialized for the job types used (cannot be NULL).
+ *                     It is only read, so all workers share it.
+ *           n:        the number of jobs
+ *           nthreads: the number of workers to use (values below 1 mean 1)
+ *           executor: function running the workers on the caller's threads, or NULL to have the
+ *                     library start nthreads - 1 threads of its own and use the calling one too.
+ *           data:     arbitrary data pointer passed to the executor.
+ *  In/Out:  jobs:     the jobs; their results are filled in (cannot be NULL if n > 0).
+ *
+ *  Each worker starts with an equal share of the jobs and takes them one at a time; one that
+ *  runs out steals half of what another has left, so cheap and expensive jobs balance out.
+ *  Jobs of an unknown type get result 0. If the library was built without thread support,
+ *  all jobs run on the calling thread and nthreads and executor are ignored.
+ */
+int secp256k1_verify_batch_parallel(
+  const secp256k1_context_t* ctx,
+  secp256k1_verify_job_t *jobs,
+  size_t n,
+  int nthreads,
+  secp256k1_executor_function_t executor,
+  void *data
+) SECP256K1_ARG_NONNULL(1);
+
+/** Scan a batch of range proofs for the ones which can be rewound with any of a set of candidate nonces.
+ *  Returns the number of proofs which were successfully rewound.
+ *  In:   ctx: pointer to a context object, initialized for range-proof, signing, verification and commitment (cannot be NULL)
+ *        nonces: pointer to pointers to 32-byte candidate nonces. (cannot be NULL if nnonces is non-zero)
+ *        nnonces: number of candidate nonces.
+ *        commits: pointer to pointers to the 33-byte commitments being proved. (cannot be NULL)
+ *        proofs: pointer to pointers to the proofs. (cannot be NULL)
+ *        plens: lengths of the proofs in bytes. (cannot be NULL)
+ *        n: number of proofs in this batch.
+ *        nthreads: the number of workers to use (values below 1 mean 1)
+ *        executor: function running the workers on the caller's threads, or NULL to have the
+ *                  library start nthreads - 1 threads of its own and use the calling one too.
+ *        data: arbitrary data pointer passed to the executor.
+ *  Out:  nonce_idx: array of n ints, set to the index of the nonce which rewound each proof, or -1. (cannot be NULL)
+ *        blinds_out: array of 32*n bytes for the recovered blinding factors (can be NULL)
+ *        values_out: array of n unsigned int64s for the recovered values (can be NULL)
+ *        messages_out: array of 4096*n bytes for the recovered messages (can be NULL)
+ *        mlens: array of n ints for the recovered message lengths (can be NULL, must not be NULL if messages_out is not)
+ *  Outputs for proofs which were not rewound are left untouched, except nonce_idx.
+ *
+ *  Each nonce is first tried with secp256k1_rangeproof_rewind_check, so only matching proofs are fully verified.
+ *  The proofs are shared out among the workers as by secp256k1_verify_batch_parallel, each worker
+ *  trying every nonce against one proof at a time. If the library was built without thread support,
+ *  the scan runs on the calling thread and nthreads and executor are ignored.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_rangeproof_rewind_scan(
+ const secp256k1_context_t* ctx,
+ int *nonce_idx,
+ unsigned char *blinds_out,
+ uint64_t *values_out,
+ unsigned char *messages_out,
+ int *mlens,
+ const unsigned char * const *nonces,
+ int nnonces,
+ const unsigned char * const *commits,
+ const unsigned char * const *proofs,
+ const int *plens,
+ int n,
+ int nthreads,
+ secp256k1_executor_function_t executor,
+ void *data
+)SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(9) SECP256K1_ARG_NONNULL(10) SECP256K1_ARG_NONNULL(11);
+
+/** Opaque data structure for verifying jobs in the background: jobs are submitted without
+ *  blocking and run on worker threads that the verifier owns, and the finished ones are
+ *  either handed to a callback or collected with secp256k1_verifier_poll.
+ */
+typedef struct secp256k1_verifier_struct secp256k1_verifier_t;
+
+/** A pointer to a function called on a worker thread with each finished job.
+ *  In:      job:  the job, with its result filled in. The verifier is done with it.
+ *           data: arbitrary data pointer that is passed through.
+ *  It may run on several workers at once, and may submit new jobs.
+ */
+typedef void (*secp256k1_verify_callback_t)(
+  secp256k1_verify_job_t *job,
+  void *data
+);
+
+/** Create a verifier.
+ *  Returns: a newly created verifier, or NULL if its threads or its notification descriptor
+ *           could not be created.
+ *  In:      ctx:      the context the jobs are checked with, as for secp256k1_verify_batch_parallel
+ *                     (cannot be NULL). It must outlive the verifier and stay unmodified.
+ *           nthreads: the number of worker threads (values below 1 mean 1)
+ *           capacity: the most jobs that may be submitted and not yet done (cannot be 0). Without
+ *                     a callback, a job counts until secp256k1_verifier_poll returns it.
+ *           callback: function called with each finished job, or NULL to queue them for
+ *                     secp256k1_verifier_poll instead.
+ *           data:     arbitrary data pointer passed to the callback.
+ *  If the library was built without thread support, jobs are instead checked inside
+ *  secp256k1_verifier_submit, and complete as they would otherwise.
+ */
+secp256k1_verifier_t* secp256k1_verifier_create(
+  const secp256k1_context_t* ctx,
+  int nthreads,
+  size_t capacity,
+  secp256k1_verify_callback_t callback,
+  void *data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Destroy a verifier. Waits until every submitted job is done (calling the callback for each);
+ *  finished jobs that were not polled are dropped. The pointer may not be used afterwards. */
+void secp256k1_verifier_destroy(
+  secp256k1_verifier_t* verifier
+) SECP256K1_ARG_NONNULL(1);
+
+/** Queue a job for verification, without blocking. May be called from any thread.
+ *  Returns: 1 if the job was queued, 0 if the verifier is at capacity.
+ *  In:      verifier: the verifier (cannot be NULL)
+ *  In/Out:  job:      the job (cannot be NULL). It, and everything it points to, must stay valid and
+ *                     unmodified until it is handed back.
+ */
+SECP256K1_WARN_UNUSED_RESULT int secp256k1_verifier_submit(
+  secp256k1_verifier_t* verifier,
+  secp256k1_verify_job_t *job
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Get the descriptor that becomes readable when finished jobs are waiting to be polled.
+ *  Returns: an eventfd for use with poll/epoll, or -1 if the verifier has a callback or
+ *           the system has no eventfd. Do not read from or close it.
+ *  In:      verifier: the verifier (cannot be NULL)
+ */
+int secp256k1_verifier_fd(
+  const secp256k1_verifier_t* verifier
+) SECP256K1_ARG_NONNULL(1);
+
+/** Collect finished jobs, without blocking. Must not be called from several threads at once.
+ *  Returns: the number of jobs written to jobs (0 if none are finished, or if the verifier
+ *           has a callback).
+ *  In:      verifier: the verifier (cannot be NULL)
+ *           max:      the size of the jobs array
+ *  Out:     jobs:     the finished jobs, oldest first; the verifier is done with them.
+ */
+size_t secp256k1_verifier_poll(
+  secp256k1_verifier_t* verifier,
+  secp256k1_verify_job_t **jobs,
+  size_t max
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 # ifdef __cplusplus
 }
 # endif
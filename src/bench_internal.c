@@ -8,10 +8,12 @@
 #include "include/secp256k1.h"
 
 #include "util.h"
+#include "cpu_impl.h"
 #include "hash_impl.h"
 #include "num_impl.h"
 #include "field_impl.h"
 #include "group_impl.h"
+#include "group_4way_impl.h"
 #include "scalar_impl.h"
 #include "ecmult_impl.h"
 #include "bench.h"
@@ -21,8 +23,10 @@ typedef struct {
     secp256k1_fe_t fe_x, fe_y;
     secp256k1_ge_t ge_x, ge_y;
     secp256k1_gej_t gej_x, gej_y;
+    secp256k1_fe4_t fe4_x, fe4_y;
+    secp256k1_gej4_t gej4_x;
     unsigned char data[32];
-    int wnaf[256];
+    int16_t wnaf[256];
 } bench_inv_t;
 
 void bench_setup(void* arg) {
@@ -50,6 +54,19 @@ void bench_setup(void* arg) {
     CHECK(secp256k1_ge_set_xo_var(&data->ge_y, &data->fe_y, 1));
     secp256k1_gej_set_ge(&data->gej_x, &data->ge_x);
     secp256k1_gej_set_ge(&data->gej_y, &data->ge_y);
+    {
+        secp256k1_fe_t fe[4];
+        secp256k1_gej_t gej[4];
+        fe[0] = fe[2] = data->fe_x;
+        fe[1] = fe[3] = data->fe_y;
+        secp256k1_fe4_set_fe(&data->fe4_x, fe);
+        fe[0] = fe[2] = data->fe_y;
+        fe[1] = fe[3] = data->fe_x;
+        secp256k1_fe4_set_fe(&data->fe4_y, fe);
+        gej[0] = gej[2] = data->gej_x;
+        gej[1] = gej[3] = data->gej_y;
+        secp256k1_gej4_set_gej(&data->gej4_x, gej);
+    }
     memcpy(data->data, init_x, 32);
 }
 
@@ -122,6 +139,25 @@ void bench_scalar_inverse_var(void* arg) {
     }
 }
 
+void bench_scalar_inv_all_var(void* arg) {
+    int i, j;
+    bench_inv_t *data = (bench_inv_t*)arg;
+    secp256k1_scalar_t x[16], xi[16];
+
+    /* Inverts 2000 scalars in batches of 16, so the result is comparable to scalar_inverse_var. */
+    for (j = 0; j < 16; j++) {
+        x[j] = data->scalar_x;
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+    for (i = 0; i < 125; i++) {
+        secp256k1_scalar_inv_all_var(16, xi, x);
+        for (j = 0; j < 16; j++) {
+            secp256k1_scalar_add(&x[j], &xi[j], &data->scalar_y);
+        }
+    }
+    data->scalar_x = x[0];
+}
+
 void bench_field_normalize(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -158,6 +194,25 @@ void bench_field_sqr(void* arg) {
     }
 }
 
+/* The 4-way benchmarks do a quarter of the calls, so their timings are per element. */
+void bench_field_mul_4way(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_fe4_mul(&data->fe4_x, &data->fe4_x, &data->fe4_y);
+    }
+}
+
+void bench_field_sqr_4way(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_fe4_sqr(&data->fe4_x, &data->fe4_x);
+    }
+}
+
 void bench_field_inverse(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -197,6 +252,15 @@ void bench_group_double_var(void* arg) {
     }
 }
 
+void bench_group_double_4way(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 50000; i++) {
+        secp256k1_gej4_double(&data->gej4_x, &data->gej4_x);
+    }
+}
+
 void bench_group_add_var(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -234,6 +298,16 @@ void bench_ecmult_wnaf(void* arg) {
     }
 }
 
+void bench_ecmult_wnaf_g(void* arg) {
+    int i;
+    bench_inv_t *data = (bench_inv_t*)arg;
+
+    for (i = 0; i < 20000; i++) {
+        secp256k1_ecmult_wnaf(data->wnaf, &data->scalar_x, WINDOW_G);
+        secp256k1_scalar_add(&data->scalar_x, &data->scalar_x, &data->scalar_y);
+    }
+}
+
 
 void bench_sha256(void* arg) {
     int i;
@@ -247,6 +321,25 @@ void bench_sha256(void* arg) {
     }
 }
 
+void bench_sha256_multi(void* arg) {
+    int i;
+    int l;
+    bench_inv_t *data = (bench_inv_t*)arg;
+    secp256k1_sha256_multi_t sha;
+    const unsigned char *ptrs[SECP256K1_SHA256_MAX_LANES];
+    unsigned char out[SECP256K1_SHA256_MAX_LANES * 32];
+
+    for (l = 0; l < SECP256K1_SHA256_MAX_LANES; l++) {
+        ptrs[l] = data->data;
+    }
+    for (i = 0; i < 20000 / SECP256K1_SHA256_MAX_LANES; i++) {
+        secp256k1_sha256_multi_initialize(&sha, SECP256K1_SHA256_MAX_LANES);
+        secp256k1_sha256_multi_write(&sha, ptrs, 32);
+        secp256k1_sha256_multi_finalize(&sha, out);
+        memcpy(data->data, out, 32);
+    }
+}
+
 void bench_hmac_sha256(void* arg) {
     int i;
     bench_inv_t *data = (bench_inv_t*)arg;
@@ -286,6 +379,7 @@ int have_flag(int argc, char** argv, char *flag) {
 
 int main(int argc, char **argv) {
     bench_inv_t data;
+    secp256k1_cpu_init();
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "add")) run_benchmark("scalar_add", bench_scalar_add, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "negate")) run_benchmark("scalar_negate", bench_scalar_negate, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "sqr")) run_benchmark("scalar_sqr", bench_scalar_sqr, bench_setup, NULL, &data, 10, 200000);
@@ -295,23 +389,29 @@ int main(int argc, char **argv) {
 #endif
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inverse", bench_scalar_inverse, bench_setup, NULL, &data, 10, 2000);
     if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inverse_var", bench_scalar_inverse_var, bench_setup, NULL, &data, 10, 2000);
+    if (have_flag(argc, argv, "scalar") || have_flag(argc, argv, "inverse")) run_benchmark("scalar_inv_all_var", bench_scalar_inv_all_var, bench_setup, NULL, &data, 10, 2000);
 
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "normalize")) run_benchmark("field_normalize", bench_field_normalize, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "normalize")) run_benchmark("field_normalize_weak", bench_field_normalize_weak, bench_setup, NULL, &data, 10, 2000000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqr")) run_benchmark("field_sqr", bench_field_sqr, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul", bench_field_mul, bench_setup, NULL, &data, 10, 200000);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqr")) run_benchmark("field_sqr_4way", bench_field_sqr_4way, bench_setup, NULL, &data, 10, 200000);
+    if (have_flag(argc, argv, "field") || have_flag(argc, argv, "mul")) run_benchmark("field_mul_4way", bench_field_mul_4way, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse", bench_field_inverse, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "inverse")) run_benchmark("field_inverse_var", bench_field_inverse_var, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "field") || have_flag(argc, argv, "sqrt")) run_benchmark("field_sqrt_var", bench_field_sqrt_var, bench_setup, NULL, &data, 10, 20000);
 
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_var", bench_group_double_var, bench_setup, NULL, &data, 10, 200000);
+    if (have_flag(argc, argv, "group") || have_flag(argc, argv, "double")) run_benchmark("group_double_4way", bench_group_double_4way, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_var", bench_group_add_var, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine", bench_group_add_affine, bench_setup, NULL, &data, 10, 200000);
     if (have_flag(argc, argv, "group") || have_flag(argc, argv, "add")) run_benchmark("group_add_affine_var", bench_group_add_affine_var, bench_setup, NULL, &data, 10, 200000);
 
     if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("ecmult_wnaf", bench_ecmult_wnaf, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "ecmult") || have_flag(argc, argv, "wnaf")) run_benchmark("ecmult_wnaf_g", bench_ecmult_wnaf_g, bench_setup, NULL, &data, 10, 20000);
 
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256", bench_sha256, bench_setup, NULL, &data, 10, 20000);
+    if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "sha256")) run_benchmark("hash_sha256_multi", bench_sha256_multi, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "hmac")) run_benchmark("hash_hmac_sha256", bench_hmac_sha256, bench_setup, NULL, &data, 10, 20000);
     if (have_flag(argc, argv, "hash") || have_flag(argc, argv, "rng6979")) run_benchmark("hash_rfc6979_hmac_sha256", bench_rfc6979_hmac_sha256, bench_setup, NULL, &data, 10, 20000);
     return 0;
@@ -10,6 +10,7 @@
 
 typedef struct {
     secp256k1_context_t* ctx;
+    secp256k1_presig_pool_t* pool;
     unsigned char msg[32];
     unsigned char key[32];
 } bench_sign_t;
@@ -38,13 +39,64 @@ static void bench_sign(void* arg) {
     }
 }
 
+static void bench_sign_batch(void* arg) {
+    int i, j;
+    bench_sign_t *data = (bench_sign_t*)arg;
+
+    unsigned char msg[32][32];
+    unsigned char sig[32][72];
+    int siglen[32];
+    const unsigned char *mptr[32], *kptr[32];
+    unsigned char *sptr[32];
+    for (j = 0; j < 32; j++) {
+        memcpy(msg[j], data->msg, 32);
+        msg[j][0] ^= j;
+        mptr[j] = msg[j];
+        kptr[j] = data->key;
+        sptr[j] = sig[j];
+    }
+    for (i = 0; i < 20000; i += 32) {
+        for (j = 0; j < 32; j++) {
+            siglen[j] = 72;
+        }
+        CHECK(secp256k1_ecdsa_sign_batch(data->ctx, mptr, sptr, siglen, kptr, 32, NULL, NULL));
+        for (j = 0; j < 32; j++) {
+            memcpy(msg[j], sig[j] + siglen[j] - 32, 32); /* Move former S to message. */
+        }
+    }
+}
+
+static void bench_sign_pool_setup(void* arg) {
+    bench_sign_t *data = (bench_sign_t*)arg;
+
+    bench_sign_setup(arg);
+    CHECK(secp256k1_presig_pool_refill(data->ctx, data->pool, NULL) == 20000);
+}
+
+static void bench_sign_with_pool(void* arg) {
+    int i;
+    bench_sign_t *data = (bench_sign_t*)arg;
+
+    unsigned char sig[72];
+    for (i = 0; i < 20000; i++) {
+        int siglen = 72;
+        CHECK(secp256k1_ecdsa_sign_with_pool(data->ctx, data->pool, data->msg, sig, &siglen, data->key));
+        memcpy(data->msg, sig + siglen - 32, 32); /* Move former S to message. */
+    }
+}
+
 int main(void) {
     bench_sign_t data;
+    unsigned char seed[32] = {0}; /* A fixed seed is only acceptable in a benchmark. */
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    data.pool = secp256k1_presig_pool_create(20000, seed);
 
     run_benchmark("ecdsa_sign", bench_sign, bench_sign_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdsa_sign_batch", bench_sign_batch, bench_sign_setup, NULL, &data, 10, 20000);
+    run_benchmark("ecdsa_sign_with_pool", bench_sign_with_pool, bench_sign_pool_setup, NULL, &data, 10, 20000);
 
+    secp256k1_presig_pool_destroy(data.pool);
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
@@ -19,6 +19,7 @@ typedef struct {
     int siglen;
     unsigned char pubkey[33];
     int pubkeylen;
+    secp256k1_verify_job_t jobs[200];
 } benchmark_verify_t;
 
 static void benchmark_verify(void* arg) {
@@ -36,6 +37,15 @@ static void benchmark_verify(void* arg) {
     }
 }
 
+static void benchmark_verify_parallel(void* arg) {
+    int i;
+    benchmark_verify_t* data = (benchmark_verify_t*)arg;
+
+    for (i = 0; i < 100; i++) {
+        CHECK(secp256k1_verify_batch_parallel(data->ctx, data->jobs, 200, 4, NULL, NULL));
+    }
+}
+
 int main(void) {
     int i;
     benchmark_verify_t data;
@@ -51,6 +61,16 @@ int main(void) {
 
     run_benchmark("ecdsa_verify", benchmark_verify, NULL, NULL, &data, 10, 20000);
 
+    for (i = 0; i < 200; i++) {
+        data.jobs[i].type = SECP256K1_VERIFY_JOB_ECDSA;
+        data.jobs[i].u.ecdsa.msg32 = data.msg;
+        data.jobs[i].u.ecdsa.sig = data.sig;
+        data.jobs[i].u.ecdsa.siglen = data.siglen;
+        data.jobs[i].u.ecdsa.pubkey = data.pubkey;
+        data.jobs[i].u.ecdsa.pubkeylen = data.pubkeylen;
+    }
+    run_benchmark("ecdsa_verify_parallel_4", benchmark_verify_parallel, NULL, NULL, &data, 10, 20000);
+
     secp256k1_context_destroy(data.ctx);
     return 0;
 }
@@ -37,6 +37,29 @@ SECP256K1_INLINE static void secp256k1_borromean_hash(unsigned char *hash, const
     secp256k1_sha256_finalize(&sha256_en, hash);
 }
 
+/* Computes secp256k1_borromean_hash for n rings at once; lane l hashes e[l] for ring ridx[l] at position eidx[l]. */
+SECP256K1_INLINE static void secp256k1_borromean_hash_multi(unsigned char *hashes, const unsigned char *m, int mlen,
+ const unsigned char * const *e, int elen, const int *ridx, const int *eidx, int n) {
+    uint32_t ring[SECP256K1_SHA256_MAX_LANES];
+    uint32_t epos[SECP256K1_SHA256_MAX_LANES];
+    const unsigned char *ringp[SECP256K1_SHA256_MAX_LANES];
+    const unsigned char *eposp[SECP256K1_SHA256_MAX_LANES];
+    secp256k1_sha256_multi_t sha256_en;
+    int l;
+    for (l = 0; l < n; l++) {
+        ring[l] = BE32((uint32_t)ridx[l]);
+        epos[l] = BE32((uint32_t)eidx[l]);
+        ringp[l] = (const unsigned char*)&ring[l];
+        eposp[l] = (const unsigned char*)&epos[l];
+    }
+    secp256k1_sha256_multi_initialize(&sha256_en, n);
+    secp256k1_sha256_multi_write(&sha256_en, e, elen);
+    secp256k1_sha256_multi_write_common(&sha256_en, m, mlen);
+    secp256k1_sha256_multi_write(&sha256_en, ringp, 4);
+    secp256k1_sha256_multi_write(&sha256_en, eposp, 4);
+    secp256k1_sha256_multi_finalize(&sha256_en, hashes);
+}
+
 /**  "Borromean" ring signature.
  *   Verifies nrings concurrent ring signatures all sharing a challenge value.
  *   Signature is one s value per pubkey and a hash.
@@ -58,8 +81,20 @@ int secp256k1_borromean_verify(const secp256k1_ecmult_context_t* ecmult_ctx, sec
     secp256k1_scalar_t ens;
     secp256k1_sha256_t sha256_e0;
     unsigned char tmp[33];
+    unsigned char rs[SECP256K1_SHA256_MAX_LANES][33];
+    unsigned char hashes[SECP256K1_SHA256_MAX_LANES * 32];
+    unsigned char next[SECP256K1_SHA256_MAX_LANES * 32];
+    const unsigned char *es[SECP256K1_SHA256_MAX_LANES];
+    int ridx[SECP256K1_SHA256_MAX_LANES];
+    int eidx[SECP256K1_SHA256_MAX_LANES];
+    int lane[SECP256K1_SHA256_MAX_LANES];
+    int first[SECP256K1_SHA256_MAX_LANES];
     int i;
     int j;
+    int l;
+    int n;
+    int lanes;
+    int maxsize;
     int count;
     int size;
     int overflow;
@@ -72,32 +107,62 @@ int secp256k1_borromean_verify(const secp256k1_ecmult_context_t* ecmult_ctx, sec
     VERIFY_CHECK(m != NULL);
     count = 0;
     secp256k1_sha256_initialize(&sha256_e0);
-    for (i = 0; i < nrings; i++) {
-        DEBUG_CHECK(INT_MAX - count > rsizes[i]);
-        secp256k1_borromean_hash(tmp, m, mlen, e0, 32, i, 0);
-        secp256k1_scalar_set_b32(&ens, tmp, &overflow);
-        for (j = 0; j < rsizes[i]; j++) {
-            if (overflow || secp256k1_scalar_is_zero(&s[count]) || secp256k1_scalar_is_zero(&ens) || secp256k1_gej_is_infinity(&pubs[count])) {
-                return 0;
+    for (i = 0; i < nrings; i += lanes) {
+        /* Walk a group of rings in lockstep, so that each step's challenges are hashed together. */
+        lanes = nrings - i < SECP256K1_SHA256_MAX_LANES ? nrings - i : SECP256K1_SHA256_MAX_LANES;
+        maxsize = 0;
+        for (l = 0; l < lanes; l++) {
+            DEBUG_CHECK(INT_MAX - count > rsizes[i + l]);
+            first[l] = count;
+            count += rsizes[i + l];
+            if (rsizes[i + l] > maxsize) {
+                maxsize = rsizes[i + l];
             }
-            if (evalues) {
-                /*If requested, save the challenges for proof rewind.*/
-                evalues[count] = ens;
-            }
-            secp256k1_ecmult(ecmult_ctx, &rgej, &pubs[count], &ens, &s[count]);
-            if (secp256k1_gej_is_infinity(&rgej)) {
-                return 0;
+            es[l] = e0;
+            ridx[l] = i + l;
+            eidx[l] = 0;
+        }
+        secp256k1_borromean_hash_multi(hashes, m, mlen, es, 32, ridx, eidx, lanes);
+        for (j = 0; j < maxsize; j++) {
+            n = 0;
+            for (l = 0; l < lanes; l++) {
+                int k;
+                if (j >= rsizes[i + l]) {
+                    continue;
+                }
+                k = first[l] + j;
+                secp256k1_scalar_set_b32(&ens, &hashes[l * 32], &overflow);
+                if (overflow || secp256k1_scalar_is_zero(&s[k]) || secp256k1_scalar_is_zero(&ens) || secp256k1_gej_is_infinity(&pubs[k])) {
+                    return 0;
+                }
+                if (evalues) {
+                    /*If requested, save the challenges for proof rewind.*/
+                    evalues[k] = ens;
+                }
+                secp256k1_ecmult(ecmult_ctx, &rgej, &pubs[k], &ens, &s[k]);
+                if (secp256k1_gej_is_infinity(&rgej)) {
+                    return 0;
+                }
+                /* OPT: loop can be hoisted and split to use batch inversion across all the rings; this would make it much faster. */
+                secp256k1_ge_set_gej_var(&rge, &rgej);
+                secp256k1_eckey_pubkey_serialize(&rge, rs[l], &size, 1);
+                if (j != rsizes[i + l] - 1) {
+                    es[n] = rs[l];
+                    ridx[n] = i + l;
+                    eidx[n] = j + 1;
+                    lane[n] = l;
+                    n++;
+                }
             }
-            /* OPT: loop can be hoisted and split to use batch inversion across all the rings; this would make it much faster. */
-            secp256k1_ge_set_gej_var(&rge, &rgej);
-            secp256k1_eckey_pubkey_serialize(&rge, tmp, &size, 1);
-            if (j != rsizes[i] - 1) {
-                secp256k1_borromean_hash(tmp, m, mlen, tmp, 33, i, j + 1);
-                secp256k1_scalar_set_b32(&ens, tmp, &overflow);
-            } else {
-                secp256k1_sha256_write(&sha256_e0, tmp, size);
+            if (n > 0) {
+                secp256k1_borromean_hash_multi(next, m, mlen, es, 33, ridx, eidx, n);
+                for (l = 0; l < n; l++) {
+                    memcpy(&hashes[lane[l] * 32], &next[l * 32], 32);
+                }
             }
-            count++;
+        }
+        for (l = 0; l < lanes; l++) {
+            secp256k1_sha256_write(&sha256_e0, rs[l], 33);
         }
     }
     secp256k1_sha256_write(&sha256_e0, m, mlen);
@@ -113,8 +178,14 @@ int secp256k1_borromean_sign(const secp256k1_ecmult_context_t* ecmult_ctx, const
     secp256k1_scalar_t ens;
     secp256k1_sha256_t sha256_e0;
     unsigned char tmp[33];
+    unsigned char hashes[SECP256K1_SHA256_MAX_LANES * 32];
+    const unsigned char *es[SECP256K1_SHA256_MAX_LANES];
+    int ridx[SECP256K1_SHA256_MAX_LANES];
+    int eidx[SECP256K1_SHA256_MAX_LANES];
     int i;
     int j;
+    int l;
+    int lanes;
     int count;
     int size;
     int overflow;
@@ -164,8 +235,17 @@ int secp256k1_borromean_sign(const secp256k1_ecmult_context_t* ecmult_ctx, const
     count = 0;
     for (i = 0; i < nrings; i++) {
         DEBUG_CHECK(INT_MAX - count > rsizes[i]);
-        secp256k1_borromean_hash(tmp, m, mlen, e0, 32, i, 0);
-        secp256k1_scalar_set_b32(&ens, tmp, &overflow);
+        if (i % SECP256K1_SHA256_MAX_LANES == 0) {
+            /* The initial challenges only depend on e0, so hash a whole group of rings at once. */
+            lanes = nrings - i < SECP256K1_SHA256_MAX_LANES ? nrings - i : SECP256K1_SHA256_MAX_LANES;
+            for (l = 0; l < lanes; l++) {
+                es[l] = e0;
+                ridx[l] = i + l;
+                eidx[l] = 0;
+            }
+            secp256k1_borromean_hash_multi(hashes, m, mlen, es, 32, ridx, eidx, lanes);
+        }
+        secp256k1_scalar_set_b32(&ens, &hashes[(i % SECP256K1_SHA256_MAX_LANES) * 32], &overflow);
         if (overflow || secp256k1_scalar_is_zero(&ens)) {
             return 0;
         }
@@ -0,0 +1,39 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_CPU_
+#define _SECP256K1_CPU_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+/** Optional instruction set extensions that have a specialized kernel somewhere in the library.
+ *  A flag is only set if both the CPU and the OS (for the vector register state) support it. */
+#define SECP256K1_CPU_AVX2  (1 << 0) /* AVX2: 8-way SHA-256, generator table scans. */
+#define SECP256K1_CPU_BMI2  (1 << 1) /* MULX and ADCX/ADOX (BMI2 + ADX): scalar multiplication. */
+#define SECP256K1_CPU_SHANI (1 << 2) /* SHA extensions (with SSSE3/SSE4.1): SHA-256. */
+#define SECP256K1_CPU_IFMA  (1 << 3) /* AVX-512 IFMA with AVX-512VL: 4-way field multiplication. */
+
+/** What the CPU supports. It stays 0 (so only the baseline kernels run) until secp256k1_cpu_init
+ *  has probed the CPU, which context creation does, and is written only that once. */
+static int secp256k1_cpu_features = 0;
+
+/** Features to ignore even if the CPU has them. Only the tests set bits, to exercise the fallbacks. */
+static int secp256k1_cpu_disabled = 0;
+
+/** Probe the CPU and set secp256k1_cpu_features, the first time it is called. Safe to call from
+ *  several threads at once; the calls that return later see the probed value. */
+static void secp256k1_cpu_init(void);
+
+/** Whether the kernels selected by feature (one of the SECP256K1_CPU_* flags) may run. */
+static SECP256K1_INLINE int secp256k1_cpu_has(int feature) {
+    return (secp256k1_cpu_features & ~secp256k1_cpu_disabled & feature) != 0;
+}
+
+#endif
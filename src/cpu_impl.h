@@ -0,0 +1,70 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_CPU_IMPL_H_
+#define _SECP256K1_CPU_IMPL_H_
+
+#include "cpu.h"
+
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
+#if defined(USE_CPU_DISPATCH)
+#include <cpuid.h>
+
+static int secp256k1_cpu_probe(void) {
+    unsigned int eax, ebx, ecx, edx, xcr0 = 0;
+    unsigned int ecx1;
+    int ret = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx) || __get_cpuid_max(0, NULL) < 7) {
+        return 0;
+    }
+    if (ecx1 & bit_OSXSAVE) {
+        /* Which register state the OS saves on context switches. */
+        __asm__ ("xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0));
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if ((xcr0 & 6) == 6 && (ecx1 & bit_AVX) && ((ebx >> 5) & 1)) {
+        ret |= SECP256K1_CPU_AVX2;
+    }
+    if (((ebx >> 8) & 1) && ((ebx >> 19) & 1)) {
+        ret |= SECP256K1_CPU_BMI2;
+    }
+    if ((ecx1 & bit_SSSE3) && (ecx1 & bit_SSE4_1) && ((ebx >> 29) & 1)) {
+        ret |= SECP256K1_CPU_SHANI;
+    }
+    /* AVX512F, AVX512IFMA and AVX512VL, with the opmask and ZMM state enabled as well. */
+    if ((xcr0 & 0xE6) == 0xE6 && ((ebx >> 16) & 1) && ((ebx >> 21) & 1) && ((ebx >> 31) & 1)) {
+        ret |= SECP256K1_CPU_IFMA;
+    }
+    return ret;
+}
+#else
+static int secp256k1_cpu_probe(void) {
+    return 0;
+}
+#endif
+
+static void secp256k1_cpu_probe_once(void) {
+    secp256k1_cpu_features = secp256k1_cpu_probe();
+}
+
+static void secp256k1_cpu_init(void) {
+#ifdef USE_PTHREADS
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, secp256k1_cpu_probe_once);
+#else
+    /* Without thread support the library has no threads of its own to race with. */
+    static int done = 0;
+    if (!done) {
+        secp256k1_cpu_probe_once();
+        done = 1;
+    }
+#endif
+}
+
+#endif
@@ -21,4 +21,30 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context_t *ctx, con
 static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context_t *ctx, secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *nonce, int *recid);
 static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, int recid);
 
+/** Set sig->s from sig->r, the message and the inverse of the nonce (noncei), in low-s form, flipping
+ *  the parity bit of *recid if recid is not NULL and s had to be negated. Returns 0 if s is zero. */
+static int secp256k1_ecdsa_sig_set_s(secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *noncei, int *recid);
+
+/** The largest number of signatures secp256k1_ecdsa_sig_sign_batch takes at once. */
+#define SECP256K1_ECDSA_SIGN_BATCH 32
+
+/** Sign n (at most SECP256K1_ECDSA_SIGN_BATCH) items with nonzero nonces at once. Sets ret[i] (and
+ *  sig[i], and recid[i] if recid is not NULL) to what secp256k1_ecdsa_sig_sign would for item i. The
+ *  R points share one constant-time field inversion, and the nonces one blinded, constant-time scalar
+ *  inversion. */
+static void secp256k1_ecdsa_sig_sign_batch(const secp256k1_ecmult_gen_context_t *ctx, int *ret, size_t n, secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *nonce, int *recid);
+
+/** The first half of secp256k1_ecdsa_sig_sign_batch, which does not need the key or message: sets
+ *  sig[i].r (and recid[i] if recid is not NULL) from nonce[i], and ni[i] to its inverse. ret[i] is 0
+ *  where r is zero. secp256k1_ecdsa_sig_set_s finishes each signature. */
+static void secp256k1_ecdsa_sig_presign_batch(const secp256k1_ecmult_gen_context_t *ctx, int *ret, size_t n, secp256k1_ecdsa_sig_t *sig, secp256k1_scalar_t *ni, const secp256k1_scalar_t *nonce, int *recid);
+
+/** Verify n signatures, sharing one scalar inversion between all of them. Sets ret[i] to what
+ *  secp256k1_ecdsa_sig_verify would return for item i. scratch must have room for 2*n scalars. */
+static void secp256k1_ecdsa_sig_verify_batch(const secp256k1_ecmult_context_t *ctx, int *ret, size_t n, const secp256k1_ecdsa_sig_t *sig, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, secp256k1_scalar_t *scratch);
+
+/** Recover n public keys, sharing one scalar inversion between all of them. Sets ret[i] (and pubkey[i])
+ *  to what secp256k1_ecdsa_sig_recover would for item i. scratch must have room for 2*n scalars. */
+static void secp256k1_ecdsa_sig_recover_batch(const secp256k1_ecmult_context_t *ctx, int *ret, size_t n, const secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, const int *recid, secp256k1_scalar_t *scratch);
+
 #endif
@@ -14,6 +14,7 @@
 #include "ecmult.h"
 #include "ecmult_gen.h"
 #include "ecdsa.h"
+#include "hash.h"
 
 /** Group order for secp256k1 defined as 'n' in "Standards for Efficient Cryptography" (SEC2) 2.7.1
  *  sage: for t in xrange(1023, -1, -1):
@@ -132,23 +133,12 @@ static int secp256k1_ecdsa_sig_serialize(unsigned char *sig, int *size, const se
     return 1;
 }
 
-static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message) {
+/* Check that the recomputed R point pr matches sig's r. */
+static int secp256k1_ecdsa_sig_check_r(const secp256k1_ecdsa_sig_t *sig, const secp256k1_gej_t *pr) {
     unsigned char c[32];
-    secp256k1_scalar_t sn, u1, u2;
     secp256k1_fe_t xr;
-    secp256k1_gej_t pubkeyj;
-    secp256k1_gej_t pr;
 
-    if (secp256k1_scalar_is_zero(&sig->r) || secp256k1_scalar_is_zero(&sig->s)) {
-        return 0;
-    }
-
-    secp256k1_scalar_inverse_var(&sn, &sig->s);
-    secp256k1_scalar_mul(&u1, &sn, message);
-    secp256k1_scalar_mul(&u2, &sn, &sig->r);
-    secp256k1_gej_set_ge(&pubkeyj, pubkey);
-    secp256k1_ecmult(ctx, &pr, &pubkeyj, &u2, &u1);
-    if (secp256k1_gej_is_infinity(&pr)) {
+    if (secp256k1_gej_is_infinity(pr)) {
         return 0;
     }
     secp256k1_scalar_get_b32(c, &sig->r);
@@ -170,7 +160,7 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context_t *ctx, con
      *  Thus, we can avoid the inversion, but we have to check both cases separately.
      *  secp256k1_gej_eq_x implements the (xr * pr.z^2 mod p == pr.x) test.
      */
-    if (secp256k1_gej_eq_x_var(&xr, &pr)) {
+    if (secp256k1_gej_eq_x_var(&xr, pr)) {
         /* xr.x == xr * xr.z^2 mod p, so the signature is valid. */
         return 1;
     }
@@ -179,25 +169,104 @@ static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context_t *ctx, con
         return 0;
     }
     secp256k1_fe_add(&xr, &secp256k1_ecdsa_const_order_as_fe);
-    if (secp256k1_gej_eq_x_var(&xr, &pr)) {
+    if (secp256k1_gej_eq_x_var(&xr, pr)) {
         /* (xr + n) * pr.z^2 mod p == pr.x, so the signature is valid. */
         return 1;
     }
     return 0;
 }
 
-static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, int recid) {
+/* Verify sig, given sn = 1/s. r and s must be nonzero. */
+static int secp256k1_ecdsa_sig_verify_sinv(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *sn, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message) {
+    secp256k1_scalar_t u1, u2;
+    secp256k1_gej_t pubkeyj;
+    secp256k1_gej_t pr;
+
+    secp256k1_scalar_mul(&u1, sn, message);
+    secp256k1_scalar_mul(&u2, sn, &sig->r);
+    secp256k1_gej_set_ge(&pubkeyj, pubkey);
+    secp256k1_ecmult(ctx, &pr, &pubkeyj, &u2, &u1);
+    return secp256k1_ecdsa_sig_check_r(sig, &pr);
+}
+
+/* secp256k1_ecdsa_sig_verify_sinv for the four items idx[0..3], with their multiplications in lock step. */
+static void secp256k1_ecdsa_sig_verify_sinv_4way(const secp256k1_ecmult_context_t *ctx, int *ret, const size_t *idx, const secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *sn, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message) {
+    secp256k1_scalar_t u1[4], u2[4];
+    secp256k1_gej_t pubkeyj[4];
+    secp256k1_gej_t pr[4];
+    int l;
+
+    for (l = 0; l < 4; l++) {
+        secp256k1_scalar_mul(&u1[l], &sn[l], &message[idx[l]]);
+        secp256k1_scalar_mul(&u2[l], &sn[l], &sig[idx[l]].r);
+        secp256k1_gej_set_ge(&pubkeyj[l], &pubkey[idx[l]]);
+    }
+    secp256k1_ecmult_4way(ctx, pr, pubkeyj, u2, u1);
+    for (l = 0; l < 4; l++) {
+        ret[idx[l]] = secp256k1_ecdsa_sig_check_r(&sig[idx[l]], &pr[l]);
+    }
+}
+
+static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message) {
+    secp256k1_scalar_t sn;
+
+    if (secp256k1_scalar_is_zero(&sig->r) || secp256k1_scalar_is_zero(&sig->s)) {
+        return 0;
+    }
+
+    secp256k1_scalar_inverse_var(&sn, &sig->s);
+    return secp256k1_ecdsa_sig_verify_sinv(ctx, sig, &sn, pubkey, message);
+}
+
+static void secp256k1_ecdsa_sig_verify_batch(const secp256k1_ecmult_context_t *ctx, int *ret, size_t n, const secp256k1_ecdsa_sig_t *sig, const secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, secp256k1_scalar_t *scratch) {
+    secp256k1_scalar_t sn[4];
+    size_t idx[4];
+    size_t i, k, lanes;
+    int lockstep;
+
+    /* Gather the s values that need inverting into scratch[0..k), and invert them into scratch[n..n+k). */
+    k = 0;
+    for (i = 0; i < n; i++) {
+        if (!secp256k1_scalar_is_zero(&sig[i].r) && !secp256k1_scalar_is_zero(&sig[i].s)) {
+            scratch[k++] = sig[i].s;
+        }
+    }
+    secp256k1_scalar_inv_all_var(k, &scratch[n], scratch);
+
+    /* Where the 4-way field kernels are vector code, run the items in groups of four through the
+     * lock-step multiplication, and what is left over singly. Where they run one lane at a time, the
+     * lock-step version only adds shuffling, so run every item singly. */
+    lockstep = secp256k1_fe4_is_vectorized();
+    k = 0;
+    lanes = 0;
+    for (i = 0; i < n; i++) {
+        if (secp256k1_scalar_is_zero(&sig[i].r) || secp256k1_scalar_is_zero(&sig[i].s)) {
+            ret[i] = 0;
+        } else if (!lockstep) {
+            ret[i] = secp256k1_ecdsa_sig_verify_sinv(ctx, &sig[i], &scratch[n + k++], &pubkey[i], &message[i]);
+        } else {
+            idx[lanes] = i;
+            sn[lanes++] = scratch[n + k++];
+            if (lanes == 4) {
+                secp256k1_ecdsa_sig_verify_sinv_4way(ctx, ret, idx, sig, sn, pubkey, message);
+                lanes = 0;
+            }
+        }
+    }
+    for (i = 0; i < lanes; i++) {
+        ret[idx[i]] = secp256k1_ecdsa_sig_verify_sinv(ctx, &sig[idx[i]], &sn[i], &pubkey[idx[i]], &message[idx[i]]);
+    }
+}
+
+/* Recover the public key of sig, given rn = 1/r. r and s must be nonzero. */
+static int secp256k1_ecdsa_sig_recover_rinv(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *rn, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, int recid) {
     unsigned char brx[32];
     secp256k1_fe_t fx;
     secp256k1_ge_t x;
     secp256k1_gej_t xj;
-    secp256k1_scalar_t rn, u1, u2;
+    secp256k1_scalar_t u1, u2;
     secp256k1_gej_t qj;
 
-    if (secp256k1_scalar_is_zero(&sig->r) || secp256k1_scalar_is_zero(&sig->s)) {
-        return 0;
-    }
-
     secp256k1_scalar_get_b32(brx, &sig->r);
     VERIFY_CHECK(secp256k1_fe_set_b32(&fx, brx)); /* brx comes from a scalar, so is less than the order; certainly less than p */
     if (recid & 2) {
@@ -210,44 +279,72 @@ static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context_t *ctx, co
         return 0;
     }
     secp256k1_gej_set_ge(&xj, &x);
-    secp256k1_scalar_inverse_var(&rn, &sig->r);
-    secp256k1_scalar_mul(&u1, &rn, message);
+    secp256k1_scalar_mul(&u1, rn, message);
     secp256k1_scalar_negate(&u1, &u1);
-    secp256k1_scalar_mul(&u2, &rn, &sig->s);
+    secp256k1_scalar_mul(&u2, rn, &sig->s);
     secp256k1_ecmult(ctx, &qj, &xj, &u2, &u1);
     secp256k1_ge_set_gej_var(pubkey, &qj);
     return !secp256k1_gej_is_infinity(&qj);
 }
 
-static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context_t *ctx, secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *nonce, int *recid) {
+static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, int recid) {
+    secp256k1_scalar_t rn;
+
+    if (secp256k1_scalar_is_zero(&sig->r) || secp256k1_scalar_is_zero(&sig->s)) {
+        return 0;
+    }
+
+    secp256k1_scalar_inverse_var(&rn, &sig->r);
+    return secp256k1_ecdsa_sig_recover_rinv(ctx, sig, &rn, pubkey, message, recid);
+}
+
+static void secp256k1_ecdsa_sig_recover_batch(const secp256k1_ecmult_context_t *ctx, int *ret, size_t n, const secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *pubkey, const secp256k1_scalar_t *message, const int *recid, secp256k1_scalar_t *scratch) {
+    size_t i, k;
+
+    k = 0;
+    for (i = 0; i < n; i++) {
+        if (!secp256k1_scalar_is_zero(&sig[i].r) && !secp256k1_scalar_is_zero(&sig[i].s)) {
+            scratch[k++] = sig[i].r;
+        }
+    }
+    secp256k1_scalar_inv_all_var(k, &scratch[n], scratch);
+
+    k = 0;
+    for (i = 0; i < n; i++) {
+        if (!secp256k1_scalar_is_zero(&sig[i].r) && !secp256k1_scalar_is_zero(&sig[i].s)) {
+            ret[i] = secp256k1_ecdsa_sig_recover_rinv(ctx, &sig[i], &scratch[n + k++], &pubkey[i], &message[i], recid[i]);
+        } else {
+            ret[i] = 0;
+        }
+    }
+}
+
+/* Set sig->r from R = nonce*G, and the recovery id if recid is not NULL. Returns 0 if r is zero. */
+static int secp256k1_ecdsa_sig_set_r(secp256k1_ecdsa_sig_t *sig, secp256k1_ge_t *r, int *recid) {
     unsigned char b[32];
-    secp256k1_gej_t rp;
-    secp256k1_ge_t r;
-    secp256k1_scalar_t n;
     int overflow = 0;
 
-    secp256k1_ecmult_gen(ctx, &rp, nonce);
-    secp256k1_ge_set_gej(&r, &rp);
-    secp256k1_fe_normalize(&r.x);
-    secp256k1_fe_normalize(&r.y);
-    secp256k1_fe_get_b32(b, &r.x);
+    secp256k1_fe_normalize(&r->x);
+    secp256k1_fe_normalize(&r->y);
+    secp256k1_fe_get_b32(b, &r->x);
     secp256k1_scalar_set_b32(&sig->r, b, &overflow);
     if (secp256k1_scalar_is_zero(&sig->r)) {
         /* P.x = order is on the curve, so technically sig->r could end up zero, which would be an invalid signature. */
-        secp256k1_gej_clear(&rp);
-        secp256k1_ge_clear(&r);
         return 0;
     }
     if (recid) {
-        *recid = (overflow ? 2 : 0) | (secp256k1_fe_is_odd(&r.y) ? 1 : 0);
+        *recid = (overflow ? 2 : 0) | (secp256k1_fe_is_odd(&r->y) ? 1 : 0);
     }
+    return 1;
+}
+
+static int secp256k1_ecdsa_sig_set_s(secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *noncei, int *recid) {
+    secp256k1_scalar_t n;
+
     secp256k1_scalar_mul(&n, &sig->r, seckey);
     secp256k1_scalar_add(&n, &n, message);
-    secp256k1_scalar_inverse(&sig->s, nonce);
-    secp256k1_scalar_mul(&sig->s, &sig->s, &n);
+    secp256k1_scalar_mul(&sig->s, noncei, &n);
     secp256k1_scalar_clear(&n);
-    secp256k1_gej_clear(&rp);
-    secp256k1_ge_clear(&r);
     if (secp256k1_scalar_is_zero(&sig->s)) {
         return 0;
     }
@@ -260,4 +357,80 @@ static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context_t *ctx, s
     return 1;
 }
 
+static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context_t *ctx, secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *nonce, int *recid) {
+    secp256k1_gej_t rp;
+    secp256k1_ge_t r;
+    secp256k1_scalar_t ni;
+    int ret;
+
+    secp256k1_ecmult_gen(ctx, &rp, nonce);
+    secp256k1_ge_set_gej(&r, &rp);
+    ret = secp256k1_ecdsa_sig_set_r(sig, &r, recid);
+    secp256k1_gej_clear(&rp);
+    secp256k1_ge_clear(&r);
+    if (!ret) {
+        return 0;
+    }
+    secp256k1_scalar_inverse(&ni, nonce);
+    ret = secp256k1_ecdsa_sig_set_s(sig, seckey, message, &ni, recid);
+    secp256k1_scalar_clear(&ni);
+    return ret;
+}
+
+static void secp256k1_ecdsa_sig_presign_batch(const secp256k1_ecmult_gen_context_t *ctx, int *ret, size_t n, secp256k1_ecdsa_sig_t *sig, secp256k1_scalar_t *ni, const secp256k1_scalar_t *nonce, int *recid) {
+    unsigned char b[32];
+    secp256k1_gej_t rp[SECP256K1_ECDSA_SIGN_BATCH];
+    secp256k1_ge_t r[SECP256K1_ECDSA_SIGN_BATCH];
+    secp256k1_scalar_t blind;
+    secp256k1_sha256_t hash;
+    size_t i;
+    VERIFY_CHECK(n <= SECP256K1_ECDSA_SIGN_BATCH);
+    if (n == 0) {
+        return;
+    }
+
+    i = 0;
+    do {
+        secp256k1_ecmult_gen(ctx, &rp[i], &nonce[i]);
+    } while (++i < n);
+    secp256k1_ge_set_all_gej(n, r, rp);
+
+    /* Blind the nonce inversion with a hash of the nonces, which is as secret as they are. A zero
+     * blind would turn every inverse into zero, but finding nonces that hash to it is infeasible. */
+    secp256k1_sha256_initialize(&hash);
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar_get_b32(b, &nonce[i]);
+        secp256k1_sha256_write(&hash, b, 32);
+    }
+    secp256k1_sha256_finalize(&hash, b);
+    secp256k1_scalar_set_b32(&blind, b, NULL);
+    if (secp256k1_scalar_is_zero(&blind)) {
+        secp256k1_scalar_set_int(&blind, 1);
+    }
+    secp256k1_scalar_inv_all(n, ni, nonce, &blind);
+
+    for (i = 0; i < n; i++) {
+        ret[i] = secp256k1_ecdsa_sig_set_r(&sig[i], &r[i], recid ? &recid[i] : NULL);
+    }
+
+    memset(b, 0, 32);
+    memset(&hash, 0, sizeof(hash));
+    secp256k1_scalar_clear(&blind);
+    for (i = 0; i < n; i++) {
+        secp256k1_gej_clear(&rp[i]);
+        secp256k1_ge_clear(&r[i]);
+    }
+}
+
+static void secp256k1_ecdsa_sig_sign_batch(const secp256k1_ecmult_gen_context_t *ctx, int *ret, size_t n, secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *seckey, const secp256k1_scalar_t *message, const secp256k1_scalar_t *nonce, int *recid) {
+    secp256k1_scalar_t ni[SECP256K1_ECDSA_SIGN_BATCH];
+    size_t i;
+
+    secp256k1_ecdsa_sig_presign_batch(ctx, ret, n, sig, ni, nonce, recid);
+    for (i = 0; i < n; i++) {
+        ret[i] = ret[i] && secp256k1_ecdsa_sig_set_s(&sig[i], &seckey[i], &message[i], &ni[i], recid ? &recid[i] : NULL);
+        secp256k1_scalar_clear(&ni[i]);
+    }
+}
+
 #endif
@@ -19,13 +19,18 @@ typedef struct {
 } secp256k1_ecmult_context_t;
 
 static void secp256k1_ecmult_context_init(secp256k1_ecmult_context_t *ctx);
-static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx);
+/** Build the tables in memory carved off *prealloc (SECP256K1_ECMULT_CONTEXT_TABLE_SIZE bytes). The
+ *  tables are owned by whoever owns that memory; clear only forgets them. */
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx, void **prealloc);
 static void secp256k1_ecmult_context_clone(secp256k1_ecmult_context_t *dst,
-                                           const secp256k1_ecmult_context_t *src);
+                                           const secp256k1_ecmult_context_t *src, void **prealloc);
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context_t *ctx);
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context_t *ctx);
 
 /** Double multiply: R = na*A + ng*G */
 static void secp256k1_ecmult(const secp256k1_ecmult_context_t *ctx, secp256k1_gej_t *r, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng);
 
+/** Four independent double multiplies in lock step: r[l] = na[l]*a[l] + ng[l]*G for l=0..3. */
+static void secp256k1_ecmult_4way(const secp256k1_ecmult_context_t *ctx, secp256k1_gej_t *r, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng);
+
 #endif
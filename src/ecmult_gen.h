@@ -32,10 +32,14 @@ typedef struct {
     secp256k1_ge_storage_t (*prec)[16][16]; /* prec[j][i] = 16^j * i * G + U_i */
 } secp256k1_ecmult_gen2_context_t;
 
+static const size_t SECP256K1_ECMULT_GEN_CONTEXT_TABLE_SIZE = ROUND_TO_ALIGN(sizeof(secp256k1_ge_storage_t) * 64 * 16);
+static const size_t SECP256K1_ECMULT_GEN2_CONTEXT_TABLE_SIZE = ROUND_TO_ALIGN(sizeof(secp256k1_ge_storage_t) * 16 * 16);
+
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context_t* ctx);
-static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t* ctx);
+/** Build the comb in memory carved off *prealloc (SECP256K1_ECMULT_GEN_CONTEXT_TABLE_SIZE bytes). */
+static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t* ctx, void **prealloc);
 static void secp256k1_ecmult_gen_context_clone(secp256k1_ecmult_gen_context_t *dst,
-                                               const secp256k1_ecmult_gen_context_t* src);
+                                               const secp256k1_ecmult_gen_context_t* src, void **prealloc);
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context_t* ctx);
 static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_context_t* ctx);
 
@@ -45,9 +49,9 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context_t* ctx, secp
 static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context_t *ctx, const unsigned char *seed32);
 
 static void secp256k1_ecmult_gen2_context_init(secp256k1_ecmult_gen2_context_t* ctx);
-static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t* ctx);
+static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t* ctx, void **prealloc);
 static void secp256k1_ecmult_gen2_context_clone(secp256k1_ecmult_gen2_context_t *dst,
-                                               const secp256k1_ecmult_gen2_context_t* src);
+                                               const secp256k1_ecmult_gen2_context_t* src, void **prealloc);
 static void secp256k1_ecmult_gen2_context_clear(secp256k1_ecmult_gen2_context_t* ctx);
 
 static int secp256k1_ecmult_gen2_context_is_built(const secp256k1_ecmult_gen2_context_t* ctx);
@@ -11,6 +11,41 @@
 #include "group.h"
 #include "ecmult_gen.h"
 #include "hash_impl.h"
+#include "cpu.h"
+
+#if defined(USE_CPU_DISPATCH)
+#include <immintrin.h>
+
+/* AVX2 version of secp256k1_ecmult_gen_table_lookup: each entry is two 256-bit halves (x and y), which
+ * are masked with an all-ones or all-zeroes compare result and ORed into the accumulators. */
+__attribute__((target("avx2"))) static void secp256k1_ecmult_gen_table_lookup_avx2(secp256k1_ge_storage_t *r, const secp256k1_ge_storage_t *table, int idx) {
+    const __m256i want = _mm256_set1_epi64x(idx);
+    __m256i x = _mm256_setzero_si256(), y = _mm256_setzero_si256();
+    int i;
+    for (i = 0; i < 16; i++) {
+        __m256i mask = _mm256_cmpeq_epi64(_mm256_set1_epi64x(i), want);
+        x = _mm256_or_si256(x, _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i*)table[i].x.n)));
+        y = _mm256_or_si256(y, _mm256_and_si256(mask, _mm256_loadu_si256((const __m256i*)table[i].y.n)));
+    }
+    _mm256_storeu_si256((__m256i*)r->x.n, x);
+    _mm256_storeu_si256((__m256i*)r->y.n, y);
+}
+#endif
+
+/* Set r to table[idx] (0 <= idx < 16), reading every entry. */
+static void secp256k1_ecmult_gen_table_lookup(secp256k1_ge_storage_t *r, const secp256k1_ge_storage_t *table, int idx) {
+    int i;
+#if defined(USE_CPU_DISPATCH)
+    if (secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+        secp256k1_ecmult_gen_table_lookup_avx2(r, table, idx);
+        return;
+    }
+#endif
+    memset(r, 0, sizeof(*r));
+    for (i = 0; i < 16; i++) {
+        secp256k1_ge_storage_cmov(r, &table[i], i == idx);
+    }
+}
 
 static void secp256k1_ecmult_gen_context_init(secp256k1_ecmult_gen_context_t *ctx) {
     ctx->prec = NULL;
@@ -20,8 +55,8 @@ static void secp256k1_ecmult_gen2_context_init(secp256k1_ecmult_gen2_context_t *
     ctx->prec = NULL;
 }
 
-static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t *ctx) {
-    secp256k1_ge_t prec[1024];
+static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t *ctx, void **prealloc) {
+    secp256k1_ge_t prec[16];
     secp256k1_gej_t gj;
     secp256k1_gej_t nums_gej;
     int i, j;
@@ -30,7 +65,7 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t *c
         return;
     }
 
-    ctx->prec = (secp256k1_ge_storage_t (*)[64][16])checked_malloc(sizeof(*ctx->prec));
+    ctx->prec = (secp256k1_ge_storage_t (*)[64][16])manual_alloc(prealloc, sizeof(*ctx->prec));
 
     /* get the generator */
     secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
@@ -47,18 +82,22 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t *c
         secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, &secp256k1_ge_const_g, NULL);
     }
 
-    /* compute prec. */
+    /* compute prec, one row of 16 at a time so the temporaries stay small. */
     {
-        secp256k1_gej_t precj[1024]; /* Jacobian versions of prec. */
+        secp256k1_gej_t precj[16]; /* Jacobian versions of a row of prec. */
         secp256k1_gej_t gbase;
         secp256k1_gej_t numsbase;
         gbase = gj; /* 16^j * G */
         numsbase = nums_gej; /* 2^j * nums. */
         for (j = 0; j < 64; j++) {
-            /* Set precj[j*16 .. j*16+15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
-            precj[j*16] = numsbase;
+            /* Set precj[0 .. 15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
+            precj[0] = numsbase;
             for (i = 1; i < 16; i++) {
-                secp256k1_gej_add_var(&precj[j*16 + i], &precj[j*16 + i - 1], &gbase, NULL);
+                secp256k1_gej_add_var(&precj[i], &precj[i - 1], &gbase, NULL);
+            }
+            secp256k1_ge_set_all_gej_var(16, prec, precj);
+            for (i = 0; i < 16; i++) {
+                secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[i]);
             }
             /* Multiply gbase by 16. */
             for (i = 0; i < 4; i++) {
@@ -72,18 +111,12 @@ static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context_t *c
                 secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
             }
         }
-        secp256k1_ge_set_all_gej_var(1024, prec, precj);
-    }
-    for (j = 0; j < 64; j++) {
-        for (i = 0; i < 16; i++) {
-            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*16 + i]);
-        }
     }
     secp256k1_ecmult_gen_blind(ctx, NULL);
 }
 
-static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t *ctx) {
-    secp256k1_ge_t prec[256];
+static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t *ctx, void **prealloc) {
+    secp256k1_ge_t prec[16];
     secp256k1_gej_t gj;
     secp256k1_gej_t nums_gej;
     int i, j;
@@ -92,7 +125,7 @@ static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t
         return;
     }
 
-    ctx->prec = (secp256k1_ge_storage_t (*)[16][16])checked_malloc(sizeof(*ctx->prec));
+    ctx->prec = (secp256k1_ge_storage_t (*)[16][16])manual_alloc(prealloc, sizeof(*ctx->prec));
 
     /* get the generator */
     secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g2);
@@ -109,18 +142,22 @@ static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t
         secp256k1_gej_add_ge_var(&nums_gej, &nums_gej, &secp256k1_ge_const_g2, NULL);
     }
 
-    /* compute prec. */
+    /* compute prec, one row of 16 at a time so the temporaries stay small. */
     {
-        secp256k1_gej_t precj[256]; /* Jacobian versions of prec. */
+        secp256k1_gej_t precj[16]; /* Jacobian versions of a row of prec. */
         secp256k1_gej_t gbase;
         secp256k1_gej_t numsbase;
         gbase = gj; /* 16^j * G */
         numsbase = nums_gej; /* 2^j * nums. */
         for (j = 0; j < 16; j++) {
-            /* Set precj[j*16 .. j*16+15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
-            precj[j*16] = numsbase;
+            /* Set precj[0 .. 15] to (numsbase, numsbase + gbase, ..., numsbase + 15*gbase). */
+            precj[0] = numsbase;
             for (i = 1; i < 16; i++) {
-                secp256k1_gej_add_var(&precj[j*16 + i], &precj[j*16 + i - 1], &gbase, NULL);
+                secp256k1_gej_add_var(&precj[i], &precj[i - 1], &gbase, NULL);
+            }
+            secp256k1_ge_set_all_gej_var(16, prec, precj);
+            for (i = 0; i < 16; i++) {
+                secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[i]);
             }
             /* Multiply gbase by 16. */
             for (i = 0; i < 4; i++) {
@@ -134,12 +171,6 @@ static void secp256k1_ecmult_gen2_context_build(secp256k1_ecmult_gen2_context_t
                 secp256k1_gej_add_var(&numsbase, &numsbase, &nums_gej, NULL);
             }
         }
-        secp256k1_ge_set_all_gej_var(256, prec, precj);
-    }
-    for (j = 0; j < 16; j++) {
-        for (i = 0; i < 16; i++) {
-            secp256k1_ge_to_storage(&(*ctx->prec)[j][i], &prec[j*16 + i]);
-        }
     }
 }
 
@@ -152,11 +183,11 @@ static int secp256k1_ecmult_gen2_context_is_built(const secp256k1_ecmult_gen2_co
 }
 
 static void secp256k1_ecmult_gen_context_clone(secp256k1_ecmult_gen_context_t *dst,
-                                               const secp256k1_ecmult_gen_context_t *src) {
+                                               const secp256k1_ecmult_gen_context_t *src, void **prealloc) {
     if (src->prec == NULL) {
         dst->prec = NULL;
     } else {
-        dst->prec = (secp256k1_ge_storage_t (*)[64][16])checked_malloc(sizeof(*dst->prec));
+        dst->prec = (secp256k1_ge_storage_t (*)[64][16])manual_alloc(prealloc, sizeof(*dst->prec));
         memcpy(dst->prec, src->prec, sizeof(*dst->prec));
         dst->initial = src->initial;
         dst->blind = src->blind;
@@ -164,24 +195,22 @@ static void secp256k1_ecmult_gen_context_clone(secp256k1_ecmult_gen_context_t *d
 }
 
 static void secp256k1_ecmult_gen2_context_clone(secp256k1_ecmult_gen2_context_t *dst,
-                                               const secp256k1_ecmult_gen2_context_t *src) {
+                                               const secp256k1_ecmult_gen2_context_t *src, void **prealloc) {
     if (src->prec == NULL) {
         dst->prec = NULL;
     } else {
-        dst->prec = (secp256k1_ge_storage_t (*)[16][16])checked_malloc(sizeof(*dst->prec));
+        dst->prec = (secp256k1_ge_storage_t (*)[16][16])manual_alloc(prealloc, sizeof(*dst->prec));
         memcpy(dst->prec, src->prec, sizeof(*dst->prec));
     }
 }
 
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context_t *ctx) {
-    free(ctx->prec);
     secp256k1_scalar_clear(&ctx->blind);
     secp256k1_gej_clear(&ctx->initial);
     ctx->prec = NULL;
 }
 
 static void secp256k1_ecmult_gen2_context_clear(secp256k1_ecmult_gen2_context_t *ctx) {
-    free(ctx->prec);
     ctx->prec = NULL;
 }
 
@@ -190,27 +219,24 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context_t *ctx, secp
     secp256k1_ge_storage_t adds;
     secp256k1_scalar_t gnb;
     int bits;
-    int i, j;
-    memset(&adds, 0, sizeof(adds));
+    int j;
     *r = ctx->initial;
     /* Blind scalar/point multiplication by computing (n-b)G + bG instead of nG. */
     secp256k1_scalar_add(&gnb, gn, &ctx->blind);
     add.infinity = 0;
     for (j = 0; j < 64; j++) {
         bits = secp256k1_scalar_get_bits(&gnb, j * 4, 4);
-        for (i = 0; i < 16; i++) {
-            /** This uses a conditional move to avoid any secret data in array indexes.
-             *   _Any_ use of secret indexes has been demonstrated to result in timing
-             *   sidechannels, even when the cache-line access patterns are uniform.
-             *  See also:
-             *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
-             *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
-             *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
-             *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
-             *    (http://www.tau.ac.il/~tromer/papers/cache.pdf)
-             */
-            secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
-        }
+        /** This uses a conditional move to avoid any secret data in array indexes.
+         *   _Any_ use of secret indexes has been demonstrated to result in timing
+         *   sidechannels, even when the cache-line access patterns are uniform.
+         *  See also:
+         *   "A word of warning", CHES 2013 Rump Session, by Daniel J. Bernstein and Peter Schwabe
+         *    (https://cryptojedi.org/peter/data/chesrump-20130822.pdf) and
+         *   "Cache Attacks and Countermeasures: the Case of AES", RSA 2006,
+         *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
+         *    (http://www.tau.ac.il/~tromer/papers/cache.pdf)
+         */
+        secp256k1_ecmult_gen_table_lookup(&adds, (*ctx->prec)[j], bits);
         secp256k1_ge_from_storage(&add, &adds);
         secp256k1_gej_add_ge(r, r, &add);
     }
@@ -270,15 +296,12 @@ static void secp256k1_ecmult_gen2_small(const secp256k1_ecmult_gen2_context_t *c
     secp256k1_ge_t add;
     secp256k1_ge_storage_t adds;
     int bits;
-    int i, j;
-    memset(&adds, 0, sizeof(adds));
+    int j;
     secp256k1_gej_set_infinity(r);
     add.infinity = 0;
     for (j = 0; j < 16; j++) {
         bits = (gn >> (j * 4)) & 15;
-        for (i = 0; i < 16; i++) {
-            secp256k1_ge_storage_cmov(&adds, &(*ctx->prec)[j][i], i == bits);
-        }
+        secp256k1_ecmult_gen_table_lookup(&adds, (*ctx->prec)[j], bits);
         secp256k1_ge_from_storage(&add, &adds);
         secp256k1_gej_add_ge(r, r, &add);
     }
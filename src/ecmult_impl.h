@@ -8,6 +8,7 @@
 #define _SECP256K1_ECMULT_IMPL_H_
 
 #include "group.h"
+#include "group_4way.h"
 #include "scalar.h"
 #include "ecmult.h"
 
@@ -27,6 +28,18 @@
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1 << ((w)-2))
 
+/** The G tables live in a single block (pre_g_128 directly follows pre_g). The context places that block
+ *  first in its table region, so every 64-byte entry fills exactly one cache line and the block starts on
+ *  a 2 MiB boundary. */
+#ifdef USE_ENDOMORPHISM
+#define ECMULT_G_TABLES 2
+#else
+#define ECMULT_G_TABLES 1
+#endif
+
+static const size_t SECP256K1_ECMULT_CONTEXT_TABLE_SIZE =
+    ROUND_TO_ALIGN(sizeof(secp256k1_ge_storage_t) * ECMULT_TABLE_SIZE(WINDOW_G) * ECMULT_G_TABLES);
+
 /** Fill a table 'prej' with precomputed odd multiples of a. Prej will contain
  *  the values [1*a,3*a,...,(2*n-1)*a], so it space for n values. zr[0] will
  *  contain prej[0].z / a.z. The other zr[i] values = prej[i].z / prej[i-1].z.
@@ -67,6 +80,9 @@ static void secp256k1_ecmult_odd_multiples_table(int n, secp256k1_gej_t *prej, s
     secp256k1_fe_mul(&prej[n-1].z, &prej[n-1].z, &d.z);
 }
 
+/** Number of points secp256k1_ecmult_odd_multiples_table_storage_var keeps in Jacobian form at once. */
+#define ECMULT_STORAGE_BATCH 64
+
 /** Fill a table 'pre' with precomputed odd multiples of a.
  *
  *  There are two versions of this function:
@@ -76,7 +92,7 @@ static void secp256k1_ecmult_odd_multiples_table(int n, secp256k1_gej_t *prej, s
  *    It only operates on tables sized for WINDOW_A wnaf multiples.
  *  - secp256k1_ecmult_odd_multiples_table_storage_var, which converts its
  *    resulting point set to actually affine points, and stores those in pre.
- *    It operates on tables of any size, but uses heap-allocated temporaries.
+ *    It operates on tables of any size, converting ECMULT_STORAGE_BATCH points at a time.
  *
  *  To compute a*P + b*G, we compute a table for P using the first function,
  *  and for G using the second (which requires an inverse, but it only needs to
@@ -93,23 +109,35 @@ static void secp256k1_ecmult_odd_multiples_table_globalz_windowa(secp256k1_ge_t
 }
 
 static void secp256k1_ecmult_odd_multiples_table_storage_var(int n, secp256k1_ge_storage_t *pre, const secp256k1_gej_t *a) {
-    secp256k1_gej_t *prej = checked_malloc(sizeof(secp256k1_gej_t) * n);
-    secp256k1_ge_t *prea = checked_malloc(sizeof(secp256k1_ge_t) * n);
-    secp256k1_fe_t *zr = checked_malloc(sizeof(secp256k1_fe_t) * n);
-    int i;
+    secp256k1_gej_t prej[ECMULT_STORAGE_BATCH];
+    secp256k1_ge_t prea[ECMULT_STORAGE_BATCH];
+    secp256k1_fe_t zr[ECMULT_STORAGE_BATCH];
+    secp256k1_gej_t d;
+    secp256k1_ge_t d_ge;
+    int i, j, m;
 
-    /* Compute the odd multiples in Jacobian form. */
-    secp256k1_ecmult_odd_multiples_table(n, prej, zr, a);
-    /* Convert them in batch to affine coordinates. */
-    secp256k1_ge_set_table_gej_var(n, prea, prej, zr);
-    /* Convert them to compact storage form. */
-    for (i = 0; i < n; i++) {
-        secp256k1_ge_to_storage(&pre[i], &prea[i]);
+    /* The multiples are a chain of additions of an affine 2*a. Converting them to affine a batch at a
+     * time keeps the temporaries bounded; each batch resumes from the last affine point. */
+    secp256k1_gej_double_var(&d, a, NULL);
+    secp256k1_ge_set_gej_var(&d_ge, &d);
+    for (i = 0; i < n; i += m) {
+        m = n - i < ECMULT_STORAGE_BATCH ? n - i : ECMULT_STORAGE_BATCH;
+        if (i == 0) {
+            prej[0] = *a;
+        } else {
+            secp256k1_gej_t last;
+            secp256k1_gej_set_ge(&last, &prea[ECMULT_STORAGE_BATCH - 1]);
+            secp256k1_gej_add_ge_var(&prej[0], &last, &d_ge, NULL);
+        }
+        for (j = 1; j < m; j++) {
+            secp256k1_gej_add_ge_var(&prej[j], &prej[j-1], &d_ge, &zr[j]);
+        }
+        /* Convert them in batch to affine coordinates, then to compact storage form. */
+        secp256k1_ge_set_table_gej_var(m, prea, prej, zr);
+        for (j = 0; j < m; j++) {
+            secp256k1_ge_to_storage(&pre[i + j], &prea[j]);
+        }
     }
-
-    free(prea);
-    free(prej);
-    free(zr);
 }
 
 /** The following two macro retrieves a particular odd multiple from a table
@@ -144,7 +172,7 @@ static void secp256k1_ecmult_context_init(secp256k1_ecmult_context_t *ctx) {
 #endif
 }
 
-static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx) {
+static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx, void **prealloc) {
     secp256k1_gej_t gj;
 
     if (ctx->pre_g != NULL) {
@@ -154,7 +182,7 @@ static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx) {
     /* get the generator */
     secp256k1_gej_set_ge(&gj, &secp256k1_ge_const_g);
 
-    ctx->pre_g = (secp256k1_ge_storage_t (*)[])checked_malloc(sizeof((*ctx->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G));
+    ctx->pre_g = (secp256k1_ge_storage_t (*)[])manual_alloc(prealloc, SECP256K1_ECMULT_CONTEXT_TABLE_SIZE);
 
     /* precompute the tables with odd multiples */
     secp256k1_ecmult_odd_multiples_table_storage_var(ECMULT_TABLE_SIZE(WINDOW_G), *ctx->pre_g, &gj);
@@ -164,7 +192,7 @@ static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx) {
         secp256k1_gej_t g_128j;
         int i;
 
-        ctx->pre_g_128 = (secp256k1_ge_storage_t (*)[])checked_malloc(sizeof((*ctx->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G));
+        ctx->pre_g_128 = (secp256k1_ge_storage_t (*)[])(*ctx->pre_g + ECMULT_TABLE_SIZE(WINDOW_G));
 
         /* calculate 2^128*generator */
         g_128j = gj;
@@ -177,23 +205,16 @@ static void secp256k1_ecmult_context_build(secp256k1_ecmult_context_t *ctx) {
 }
 
 static void secp256k1_ecmult_context_clone(secp256k1_ecmult_context_t *dst,
-                                           const secp256k1_ecmult_context_t *src) {
+                                           const secp256k1_ecmult_context_t *src, void **prealloc) {
     if (src->pre_g == NULL) {
-        dst->pre_g = NULL;
+        secp256k1_ecmult_context_init(dst);
     } else {
-        size_t size = sizeof((*dst->pre_g)[0]) * ECMULT_TABLE_SIZE(WINDOW_G);
-        dst->pre_g = (secp256k1_ge_storage_t (*)[])checked_malloc(size);
-        memcpy(dst->pre_g, src->pre_g, size);
-    }
+        dst->pre_g = (secp256k1_ge_storage_t (*)[])manual_alloc(prealloc, SECP256K1_ECMULT_CONTEXT_TABLE_SIZE);
+        memcpy(dst->pre_g, src->pre_g, SECP256K1_ECMULT_CONTEXT_TABLE_SIZE);
 #ifdef USE_ENDOMORPHISM
-    if (src->pre_g_128 == NULL) {
-        dst->pre_g_128 = NULL;
-    } else {
-        size_t size = sizeof((*dst->pre_g_128)[0]) * ECMULT_TABLE_SIZE(WINDOW_G);
-        dst->pre_g_128 = (secp256k1_ge_storage_t (*)[])checked_malloc(size);
-        memcpy(dst->pre_g_128, src->pre_g_128, size);
-    }
+        dst->pre_g_128 = (secp256k1_ge_storage_t (*)[])(*dst->pre_g + ECMULT_TABLE_SIZE(WINDOW_G));
 #endif
+    }
 }
 
 static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context_t *ctx) {
@@ -201,10 +222,6 @@ static int secp256k1_ecmult_context_is_built(const secp256k1_ecmult_context_t *c
 }
 
 static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context_t *ctx) {
-    free(ctx->pre_g);
-#ifdef USE_ENDOMORPHISM
-    free(ctx->pre_g_128);
-#endif
     secp256k1_ecmult_context_init(ctx);
 }
 
@@ -214,25 +231,37 @@ static void secp256k1_ecmult_context_clear(secp256k1_ecmult_context_t *ctx) {
  *  - two non-zero entries in wnaf are separated by at least w-1 zeroes.
  *  - the number of set values in wnaf is returned. This number is at most 256, and at most one more
  *  - than the number of bits in the (absolute value) of the input.
+ *  w must be at most 16, so that every digit fits an int16_t.
  */
-static int secp256k1_ecmult_wnaf(int *wnaf, const secp256k1_scalar_t *a, int w) {
+static int secp256k1_ecmult_wnaf(int16_t *wnaf, const secp256k1_scalar_t *a, int w) {
     secp256k1_scalar_t s = *a;
     int set_bits = 0;
     int bit = 0;
     int sign = 1;
+    int carry = 0;
+
+    VERIFY_CHECK(2 <= w && w <= 16);
 
     if (secp256k1_scalar_get_bits(&s, 255, 1)) {
         secp256k1_scalar_negate(&s, &s);
         sign = -1;
     }
 
+    /* Rather than adding the borrow of a negative digit back into s, carry it along: a digit is due at the
+     * first bit that differs from the carry, which is found up to 31 bits at a time. */
     while (bit < 256) {
         int now;
         int word;
-        if (secp256k1_scalar_get_bits(&s, bit, 1) == 0) {
-            bit++;
+        now = 256 - bit;
+        if (now > 31) {
+            now = 31;
+        }
+        word = (secp256k1_scalar_get_bits_var(&s, bit, now) ^ -carry) & ((1U << now) - 1);
+        if (word == 0) {
+            bit += now;
             continue;
         }
+        bit += secp256k1_ctz32_var(word);
         while (set_bits < bit) {
             wnaf[set_bits++] = 0;
         }
@@ -240,42 +269,63 @@ static int secp256k1_ecmult_wnaf(int *wnaf, const secp256k1_scalar_t *a, int w)
         if (bit + now > 256) {
             now = 256 - bit;
         }
-        word = secp256k1_scalar_get_bits_var(&s, bit, now);
-        if (word & (1 << (w-1))) {
-            secp256k1_scalar_add_bit(&s, bit + w);
-            wnaf[set_bits++] = sign * (word - (1 << w));
-        } else {
-            wnaf[set_bits++] = sign * word;
-        }
+        word = secp256k1_scalar_get_bits_var(&s, bit, now) + carry;
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+        wnaf[set_bits++] = sign * word;
         bit += now;
     }
+    VERIFY_CHECK(carry == 0);
     return set_bits;
 }
 
-static void secp256k1_ecmult(const secp256k1_ecmult_context_t *ctx, secp256k1_gej_t *r, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng) {
+/** Prefetch the G table entry of the highest nonzero digit in wnaf[0..n), and return its position (-1 if
+ *  there is none). Nonzero digits are at least w-1 doublings apart, so fetching the next entry as soon as
+ *  the previous one has been used hides the (likely) cache miss entirely. */
+static SECP256K1_INLINE int secp256k1_ecmult_prefetch_g(const secp256k1_ge_storage_t *pre, const int16_t *wnaf, int n) {
+    while (--n >= 0) {
+        int d = wnaf[n];
+        if (d) {
+            const secp256k1_ge_storage_t *p = &pre[(d < 0 ? -d : d) >> 1];
+            SECP256K1_PREFETCH(&p->x);
+            SECP256K1_PREFETCH(&p->y);
+            break;
+        }
+    }
+    return n;
+}
+
+/** The per-multiplication state of secp256k1_ecmult: the wNAF digits of both scalars and the odd
+ *  multiples of a, on the common Z denominator Z. */
+typedef struct {
     secp256k1_ge_t pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_ge_t tmpa;
     secp256k1_fe_t Z;
 #ifdef USE_ENDOMORPHISM
     secp256k1_ge_t pre_a_lam[ECMULT_TABLE_SIZE(WINDOW_A)];
-    secp256k1_scalar_t na_1, na_lam;
-    /* Splitted G factors. */
-    secp256k1_scalar_t ng_1, ng_128;
-    int wnaf_na_1[130];
-    int wnaf_na_lam[130];
+    int16_t wnaf_na_1[130];
+    int16_t wnaf_na_lam[130];
     int bits_na_1;
     int bits_na_lam;
-    int wnaf_ng_1[129];
+    int16_t wnaf_ng_1[129];
     int bits_ng_1;
-    int wnaf_ng_128[129];
+    int16_t wnaf_ng_128[129];
     int bits_ng_128;
 #else
-    int wnaf_na[256];
+    int16_t wnaf_na[256];
     int bits_na;
-    int wnaf_ng[257];
+    int16_t wnaf_ng[257];
     int bits_ng;
 #endif
+} secp256k1_ecmult_state_t;
+
+/* Prepare st for computing na*a + ng*G, and return the number of doublings that takes. */
+static int secp256k1_ecmult_state_init(const secp256k1_ecmult_context_t *ctx, secp256k1_ecmult_state_t *st, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng) {
+#ifdef USE_ENDOMORPHISM
+    secp256k1_scalar_t na_1, na_lam;
+    /* Splitted G factors. */
+    secp256k1_scalar_t ng_1, ng_128;
     int i;
+#endif
     int bits;
 
 #ifdef USE_ENDOMORPHISM
@@ -283,18 +333,43 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context_t *ctx, secp256k1_ge
     secp256k1_scalar_split_lambda_var(&na_1, &na_lam, na);
 
     /* build wnaf representation for na_1 and na_lam. */
-    bits_na_1   = secp256k1_ecmult_wnaf(wnaf_na_1,   &na_1,   WINDOW_A);
-    bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, &na_lam, WINDOW_A);
-    VERIFY_CHECK(bits_na_1 <= 130);
-    VERIFY_CHECK(bits_na_lam <= 130);
-    bits = bits_na_1;
-    if (bits_na_lam > bits) {
-        bits = bits_na_lam;
+    st->bits_na_1   = secp256k1_ecmult_wnaf(st->wnaf_na_1,   &na_1,   WINDOW_A);
+    st->bits_na_lam = secp256k1_ecmult_wnaf(st->wnaf_na_lam, &na_lam, WINDOW_A);
+    VERIFY_CHECK(st->bits_na_1 <= 130);
+    VERIFY_CHECK(st->bits_na_lam <= 130);
+    bits = st->bits_na_1;
+    if (st->bits_na_lam > bits) {
+        bits = st->bits_na_lam;
     }
 #else
     /* build wnaf representation for na. */
-    bits_na     = secp256k1_ecmult_wnaf(wnaf_na,     na,      WINDOW_A);
-    bits = bits_na;
+    st->bits_na     = secp256k1_ecmult_wnaf(st->wnaf_na,     na,      WINDOW_A);
+    bits = st->bits_na;
+#endif
+
+#ifdef USE_ENDOMORPHISM
+    /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
+    secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+
+    /* Build wnaf representation for ng_1 and ng_128 */
+    st->bits_ng_1   = secp256k1_ecmult_wnaf(st->wnaf_ng_1,   &ng_1,   WINDOW_G);
+    st->bits_ng_128 = secp256k1_ecmult_wnaf(st->wnaf_ng_128, &ng_128, WINDOW_G);
+    if (st->bits_ng_1 > bits) {
+        bits = st->bits_ng_1;
+    }
+    if (st->bits_ng_128 > bits) {
+        bits = st->bits_ng_128;
+    }
+    /* Start fetching the first G table entries, so they arrive while the table for a is computed. */
+    secp256k1_ecmult_prefetch_g(*ctx->pre_g, st->wnaf_ng_1, st->bits_ng_1);
+    secp256k1_ecmult_prefetch_g(*ctx->pre_g_128, st->wnaf_ng_128, st->bits_ng_128);
+#else
+    st->bits_ng     = secp256k1_ecmult_wnaf(st->wnaf_ng,     ng,      WINDOW_G);
+    if (st->bits_ng > bits) {
+        bits = st->bits_ng;
+    }
+    /* Start fetching the first G table entry, so it arrives while the table for a is computed. */
+    secp256k1_ecmult_prefetch_g(*ctx->pre_g, st->wnaf_ng, st->bits_ng);
 #endif
 
     /* Calculate odd multiples of a.
@@ -307,68 +382,113 @@ static void secp256k1_ecmult(const secp256k1_ecmult_context_t *ctx, secp256k1_ge
      * of 1/Z, so we can use secp256k1_gej_add_zinv_var, which uses the same
      * isomorphism to efficiently add with a known Z inverse.
      */
-    secp256k1_ecmult_odd_multiples_table_globalz_windowa(pre_a, &Z, a);
+    secp256k1_ecmult_odd_multiples_table_globalz_windowa(st->pre_a, &st->Z, a);
 
 #ifdef USE_ENDOMORPHISM
     for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
-        secp256k1_ge_mul_lambda(&pre_a_lam[i], &pre_a[i]);
+        secp256k1_ge_mul_lambda(&st->pre_a_lam[i], &st->pre_a[i]);
     }
+#endif
+    return bits;
+}
 
-    /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
-    secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+/* Whether secp256k1_ecmult_state_add has anything to add at bit i. */
+static SECP256K1_INLINE int secp256k1_ecmult_state_has_add(const secp256k1_ecmult_state_t *st, int i) {
+#ifdef USE_ENDOMORPHISM
+    return (i < st->bits_na_1 && st->wnaf_na_1[i]) || (i < st->bits_na_lam && st->wnaf_na_lam[i]) ||
+           (i < st->bits_ng_1 && st->wnaf_ng_1[i]) || (i < st->bits_ng_128 && st->wnaf_ng_128[i]);
+#else
+    return (i < st->bits_na && st->wnaf_na[i]) || (i < st->bits_ng && st->wnaf_ng[i]);
+#endif
+}
 
-    /* Build wnaf representation for ng_1 and ng_128 */
-    bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   &ng_1,   WINDOW_G);
-    bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, &ng_128, WINDOW_G);
-    if (bits_ng_1 > bits) {
-        bits = bits_ng_1;
+/* Add the table entries that the digits at bit i select to r. */
+static SECP256K1_INLINE void secp256k1_ecmult_state_add(const secp256k1_ecmult_context_t *ctx, const secp256k1_ecmult_state_t *st, secp256k1_gej_t *r, int i) {
+    secp256k1_ge_t tmpa;
+    int n;
+#ifdef USE_ENDOMORPHISM
+    if (i < st->bits_na_1 && (n = st->wnaf_na_1[i])) {
+        ECMULT_TABLE_GET_GE(&tmpa, st->pre_a, n, WINDOW_A);
+        secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+    }
+    if (i < st->bits_na_lam && (n = st->wnaf_na_lam[i])) {
+        ECMULT_TABLE_GET_GE(&tmpa, st->pre_a_lam, n, WINDOW_A);
+        secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+    }
+    if (i < st->bits_ng_1 && (n = st->wnaf_ng_1[i])) {
+        ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+        secp256k1_ecmult_prefetch_g(*ctx->pre_g, st->wnaf_ng_1, i);
+        secp256k1_gej_add_zinv_var(r, r, &tmpa, &st->Z);
     }
-    if (bits_ng_128 > bits) {
-        bits = bits_ng_128;
+    if (i < st->bits_ng_128 && (n = st->wnaf_ng_128[i])) {
+        ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
+        secp256k1_ecmult_prefetch_g(*ctx->pre_g_128, st->wnaf_ng_128, i);
+        secp256k1_gej_add_zinv_var(r, r, &tmpa, &st->Z);
     }
 #else
-    bits_ng     = secp256k1_ecmult_wnaf(wnaf_ng,     ng,      WINDOW_G);
-    if (bits_ng > bits) {
-        bits = bits_ng;
+    if (i < st->bits_na && (n = st->wnaf_na[i])) {
+        ECMULT_TABLE_GET_GE(&tmpa, st->pre_a, n, WINDOW_A);
+        secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+    }
+    if (i < st->bits_ng && (n = st->wnaf_ng[i])) {
+        ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
+        secp256k1_ecmult_prefetch_g(*ctx->pre_g, st->wnaf_ng, i);
+        secp256k1_gej_add_zinv_var(r, r, &tmpa, &st->Z);
     }
 #endif
+}
+
+static void secp256k1_ecmult(const secp256k1_ecmult_context_t *ctx, secp256k1_gej_t *r, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng) {
+    secp256k1_ecmult_state_t st;
+    int i;
+    int bits = secp256k1_ecmult_state_init(ctx, &st, a, na, ng);
 
     secp256k1_gej_set_infinity(r);
 
     for (i = bits - 1; i >= 0; i--) {
-        int n;
         secp256k1_gej_double_var(r, r, NULL);
-#ifdef USE_ENDOMORPHISM
-        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
-        }
-        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a_lam, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
-        }
-        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
-        }
-        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g_128, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
-        }
-#else
-        if (i < bits_na && (n = wnaf_na[i])) {
-            ECMULT_TABLE_GET_GE(&tmpa, pre_a, n, WINDOW_A);
-            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        secp256k1_ecmult_state_add(ctx, &st, r, i);
+    }
+
+    if (!r->infinity) {
+        secp256k1_fe_mul(&r->z, &r->z, &st.Z);
+    }
+}
+
+static void secp256k1_ecmult_4way(const secp256k1_ecmult_context_t *ctx, secp256k1_gej_t *r, const secp256k1_gej_t *a, const secp256k1_scalar_t *na, const secp256k1_scalar_t *ng) {
+    secp256k1_ecmult_state_t st[4];
+    secp256k1_gej4_t r4;
+    int bits = 0;
+    int i, l;
+
+    for (l = 0; l < 4; l++) {
+        int b = secp256k1_ecmult_state_init(ctx, &st[l], &a[l], &na[l], &ng[l]);
+        if (b > bits) {
+            bits = b;
         }
-        if (i < bits_ng && (n = wnaf_ng[i])) {
-            ECMULT_TABLE_GET_GE_STORAGE(&tmpa, *ctx->pre_g, n, WINDOW_G);
-            secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
+        secp256k1_gej_set_infinity(&r[l]);
+    }
+    secp256k1_gej4_set_gej(&r4, r);
+
+    for (i = bits - 1; i >= 0; i--) {
+        /* Doubling every lane, infinite ones included, costs less than four scalar doublings. The
+         * additions are sparse and scattered over the lanes, so they stay scalar. */
+        secp256k1_gej4_double(&r4, &r4);
+        for (l = 0; l < 4; l++) {
+            if (secp256k1_ecmult_state_has_add(&st[l], i)) {
+                secp256k1_gej_t rl;
+                secp256k1_gej4_get_lane(&rl, &r4, l);
+                secp256k1_ecmult_state_add(ctx, &st[l], &rl, i);
+                secp256k1_gej4_set_lane(&r4, &rl, l);
+            }
         }
-#endif
     }
 
-    if (!r->infinity) {
-        secp256k1_fe_mul(&r->z, &r->z, &Z);
+    secp256k1_gej4_get_gej(r, &r4);
+    for (l = 0; l < 4; l++) {
+        if (!r[l].infinity) {
+            secp256k1_fe_mul(&r[l].z, &r[l].z, &st[l].Z);
+        }
     }
 }
 
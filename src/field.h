@@ -22,7 +22,13 @@
 #include "libsecp256k1-config.h"
 #endif
 
+#if defined(USE_FIELD_10X26)
+#include "field_10x26.h"
+#elif defined(USE_FIELD_5X52)
 #include "field_5x52.h"
+#else
+#error "Please select field implementation"
+#endif
 
 /** Normalize a field element. */
 static void secp256k1_fe_normalize(secp256k1_fe_t *r);
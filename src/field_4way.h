@@ -0,0 +1,67 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_4WAY_
+#define _SECP256K1_FIELD_4WAY_
+
+#include "field.h"
+
+/* Limb layout of the single-element field representation. */
+#if defined(USE_FIELD_10X26)
+#define SECP256K1_FE4_LIMBS 10
+typedef uint32_t secp256k1_fe4_limb_t;
+#else
+#define SECP256K1_FE4_LIMBS 5
+typedef uint64_t secp256k1_fe4_limb_t;
+#endif
+
+/** Four independent field elements in structure-of-arrays form: n[i][l] is limb i (of the
+ *  secp256k1_fe_t representation) of lane l, so one limb of all lanes fits in a single vector. The
+ *  magnitude rules of secp256k1_fe_t apply, with one magnitude shared by all lanes. */
+typedef struct {
+    secp256k1_fe4_limb_t n[SECP256K1_FE4_LIMBS][4];
+#ifdef VERIFY
+    int magnitude;
+#endif
+} secp256k1_fe4_t;
+
+/** Whether the lane-wise multiplications run as vector code on this CPU, rather than one lane at a time. */
+static int secp256k1_fe4_is_vectorized(void);
+
+/** Load lane l of r from a[l], for l=0..3. */
+static void secp256k1_fe4_set_fe(secp256k1_fe4_t *r, const secp256k1_fe_t *a);
+
+/** Store lane l of a in r[l], for l=0..3. */
+static void secp256k1_fe4_get_fe(secp256k1_fe_t *r, const secp256k1_fe4_t *a);
+
+/** Weakly normalize every lane (see secp256k1_fe_normalize_weak). */
+static void secp256k1_fe4_normalize_weak(secp256k1_fe4_t *r);
+
+/** Normalize every lane (see secp256k1_fe_normalize). */
+static void secp256k1_fe4_normalize(secp256k1_fe4_t *r);
+
+/** Set r[l] to whether lane l of a normalizes to zero, in constant time. */
+static void secp256k1_fe4_normalizes_to_zero(int *r, secp256k1_fe4_t *a);
+
+/** Lane-wise secp256k1_fe_negate. */
+static void secp256k1_fe4_negate(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, int m);
+
+/** Lane-wise secp256k1_fe_mul_int. */
+static void secp256k1_fe4_mul_int(secp256k1_fe4_t *r, int a);
+
+/** Lane-wise secp256k1_fe_add. */
+static void secp256k1_fe4_add(secp256k1_fe4_t *r, const secp256k1_fe4_t *a);
+
+/** Lane-wise secp256k1_fe_mul: inputs of magnitude at most 8, output of magnitude 1. r may alias a or b. */
+static void secp256k1_fe4_mul(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, const secp256k1_fe4_t *b);
+
+/** Lane-wise secp256k1_fe_sqr: input of magnitude at most 8, output of magnitude 1. */
+static void secp256k1_fe4_sqr(secp256k1_fe4_t *r, const secp256k1_fe4_t *a);
+
+/** Replace lane l of r with lane l of a if flag[l] is true (flag[l] must be 0 or 1), in constant time. */
+static void secp256k1_fe4_cmov(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, const int *flag);
+
+#endif
@@ -0,0 +1,136 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_4WAY_IFMA_IMPL_H_
+#define _SECP256K1_FIELD_4WAY_IFMA_IMPL_H_
+
+#include <stdint.h>
+#include <immintrin.h>
+
+/* 4-way field multiplication with the AVX-512 IFMA instructions (on 256-bit vectors, so AVX-512VL is
+ * needed too). vpmadd52luq/vpmadd52huq add the low/high 52 bits of the 104-bit product of the low 52
+ * bits of their operands, which matches the 5x52 representation exactly, provided every limb fits in
+ * 52 bits. Inputs are therefore weakly normalized first. The ten 52-bit columns of the product (each
+ * below 2^56) are reduced with 2^260 = R = 0x1000003D10 (mod p), again using the 52-bit multipliers,
+ * and a final carry pass brings the result to magnitude 1. */
+
+#define SECP256K1_FE4_IFMA_TARGET __attribute__((target("avx512ifma,avx512vl")))
+
+/* Propagate carries from t[0..3] into the next limb, leaving t[0..3] below 2^52. */
+SECP256K1_FE4_IFMA_TARGET static SECP256K1_INLINE void secp256k1_fe4_ifma_carry(__m256i *t) {
+    const __m256i m52 = _mm256_set1_epi64x(0xFFFFFFFFFFFFFULL);
+    int i;
+    for (i = 0; i < 4; i++) {
+        t[i + 1] = _mm256_add_epi64(t[i + 1], _mm256_srli_epi64(t[i], 52));
+        t[i] = _mm256_and_si256(t[i], m52);
+    }
+}
+
+/* Fold the bits of t[4] above 48 (i.e. above 2^256) back into t[0], then carry: every limb of the
+ * result fits in 52 bits, and t[4] in 49. */
+SECP256K1_FE4_IFMA_TARGET static SECP256K1_INLINE void secp256k1_fe4_ifma_normalize_weak(__m256i *t) {
+    const __m256i m48 = _mm256_set1_epi64x(0x0FFFFFFFFFFFFULL);
+    const __m256i c3d1 = _mm256_set1_epi64x(0x3D1);
+    __m256i x = _mm256_srli_epi64(t[4], 48);
+    t[4] = _mm256_and_si256(t[4], m48);
+    /* x * 0x1000003D1, with x well below 2^32. */
+    t[0] = _mm256_add_epi64(t[0], _mm256_add_epi64(_mm256_slli_epi64(x, 32), _mm256_mul_epu32(x, c3d1)));
+    secp256k1_fe4_ifma_carry(t);
+}
+
+/* Reduce the ten product columns t[0..9] to a magnitude 1 result in r. */
+SECP256K1_FE4_IFMA_TARGET static SECP256K1_INLINE void secp256k1_fe4_ifma_reduce(secp256k1_fe4_t *r, __m256i *t) {
+    const __m256i m52 = _mm256_set1_epi64x(0xFFFFFFFFFFFFFULL);
+    const __m256i rr = _mm256_set1_epi64x(0x1000003D10ULL);
+    __m256i c, u;
+    int i;
+
+    /* Bring the upper columns to 52 bits so they can be multiplied by R; c is the carry out of t[9],
+     * worth c * 2^520 = c * R^2. */
+    for (i = 5; i < 9; i++) {
+        t[i + 1] = _mm256_add_epi64(t[i + 1], _mm256_srli_epi64(t[i], 52));
+        t[i] = _mm256_and_si256(t[i], m52);
+    }
+    c = _mm256_srli_epi64(t[9], 52);
+    t[9] = _mm256_and_si256(t[9], m52);
+
+    /* t[i] += t[i + 5] * R, with the high half of each product going into t[i + 1]. */
+    for (i = 0; i < 4; i++) {
+        t[i] = _mm256_madd52lo_epu64(t[i], t[i + 5], rr);
+        t[i + 1] = _mm256_madd52hi_epu64(t[i + 1], t[i + 5], rr);
+    }
+    t[4] = _mm256_madd52lo_epu64(t[4], t[9], rr);
+
+    /* What is left sits at 2^260: u = hi(t[9] * R) + c * R (below 2^46), added as u * R. */
+    u = _mm256_madd52hi_epu64(_mm256_madd52lo_epu64(_mm256_setzero_si256(), c, rr), t[9], rr);
+    t[0] = _mm256_madd52lo_epu64(t[0], u, rr);
+    t[1] = _mm256_madd52hi_epu64(t[1], u, rr);
+
+    /* Every t[i] is now below 2^57; two carry passes leave magnitude 1. */
+    secp256k1_fe4_ifma_carry(t);
+    secp256k1_fe4_ifma_normalize_weak(t);
+
+    for (i = 0; i < 5; i++) {
+        _mm256_storeu_si256((__m256i*)r->n[i], t[i]);
+    }
+}
+
+SECP256K1_FE4_IFMA_TARGET static void secp256k1_fe4_mul_ifma(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, const secp256k1_fe4_t *b) {
+    __m256i x[5], y[5], t[10];
+    int i, j;
+
+    for (i = 0; i < 5; i++) {
+        x[i] = _mm256_loadu_si256((const __m256i*)a->n[i]);
+        y[i] = _mm256_loadu_si256((const __m256i*)b->n[i]);
+    }
+    secp256k1_fe4_ifma_normalize_weak(x);
+    secp256k1_fe4_ifma_normalize_weak(y);
+
+    for (i = 0; i < 10; i++) {
+        t[i] = _mm256_setzero_si256();
+    }
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 5; j++) {
+            t[i + j] = _mm256_madd52lo_epu64(t[i + j], x[i], y[j]);
+            t[i + j + 1] = _mm256_madd52hi_epu64(t[i + j + 1], x[i], y[j]);
+        }
+    }
+    secp256k1_fe4_ifma_reduce(r, t);
+}
+
+SECP256K1_FE4_IFMA_TARGET static void secp256k1_fe4_sqr_ifma(secp256k1_fe4_t *r, const secp256k1_fe4_t *a) {
+    __m256i x[5], t[10];
+    int i, j;
+
+    for (i = 0; i < 5; i++) {
+        x[i] = _mm256_loadu_si256((const __m256i*)a->n[i]);
+    }
+    secp256k1_fe4_ifma_normalize_weak(x);
+
+    /* Off-diagonal products once, doubled afterwards (the inputs can't be doubled: they would no longer
+     * fit in 52 bits), then the squares. */
+    for (i = 0; i < 10; i++) {
+        t[i] = _mm256_setzero_si256();
+    }
+    for (i = 0; i < 5; i++) {
+        for (j = i + 1; j < 5; j++) {
+            t[i + j] = _mm256_madd52lo_epu64(t[i + j], x[i], x[j]);
+            t[i + j + 1] = _mm256_madd52hi_epu64(t[i + j + 1], x[i], x[j]);
+        }
+    }
+    for (i = 0; i < 10; i++) {
+        t[i] = _mm256_slli_epi64(t[i], 1);
+    }
+    for (i = 0; i < 5; i++) {
+        t[2 * i] = _mm256_madd52lo_epu64(t[2 * i], x[i], x[i]);
+        t[2 * i + 1] = _mm256_madd52hi_epu64(t[2 * i + 1], x[i], x[i]);
+    }
+    secp256k1_fe4_ifma_reduce(r, t);
+}
+
+#undef SECP256K1_FE4_IFMA_TARGET
+
+#endif
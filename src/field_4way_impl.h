@@ -0,0 +1,251 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_FIELD_4WAY_IMPL_H_
+#define _SECP256K1_FIELD_4WAY_IMPL_H_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+#include "cpu.h"
+#include "field_4way.h"
+#include "field_impl.h"
+
+#if defined(USE_FIELD_4WAY_IFMA) && defined(USE_FIELD_5X52)
+#include "field_4way_ifma_impl.h"
+#endif
+
+/* The portable kernels below work on one lane at a time through a secp256k1_fe_t, so they inherit
+ * the magnitude checks of the single-element code. The element-wise ones (add, negate, mul_int, cmov)
+ * are plain loops over the limb-major arrays, which compilers vectorize well; with 10x26 limbs negate
+ * also goes through the single-element code, as its per-limb constants differ. */
+
+static int secp256k1_fe4_is_vectorized(void) {
+#if defined(USE_FIELD_4WAY_IFMA) && defined(USE_FIELD_5X52)
+    return secp256k1_cpu_has(SECP256K1_CPU_IFMA);
+#else
+    return 0;
+#endif
+}
+
+static void secp256k1_fe4_get_lane(secp256k1_fe_t *r, const secp256k1_fe4_t *a, int l) {
+    int i;
+    for (i = 0; i < SECP256K1_FE4_LIMBS; i++) {
+        r->n[i] = a->n[i][l];
+    }
+#ifdef VERIFY
+    r->magnitude = a->magnitude;
+    r->normalized = 0;
+    secp256k1_fe_verify(r);
+#endif
+}
+
+static void secp256k1_fe4_set_lane(secp256k1_fe4_t *r, const secp256k1_fe_t *a, int l) {
+    int i;
+    for (i = 0; i < SECP256K1_FE4_LIMBS; i++) {
+        r->n[i][l] = a->n[i];
+    }
+}
+
+/* Like secp256k1_fe4_set_lane, but for use on an initialized r: its magnitude grows to cover a. */
+static void secp256k1_fe4_set_lane_magnitude(secp256k1_fe4_t *r, const secp256k1_fe_t *a, int l) {
+    secp256k1_fe4_set_lane(r, a, l);
+#ifdef VERIFY
+    secp256k1_fe_verify(a);
+    if (a->magnitude > r->magnitude) {
+        r->magnitude = a->magnitude;
+    }
+#endif
+}
+
+static void secp256k1_fe4_set_fe(secp256k1_fe4_t *r, const secp256k1_fe_t *a) {
+    int l;
+#ifdef VERIFY
+    r->magnitude = 0;
+#endif
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe4_set_lane(r, &a[l], l);
+#ifdef VERIFY
+        secp256k1_fe_verify(&a[l]);
+        if (a[l].magnitude > r->magnitude) {
+            r->magnitude = a[l].magnitude;
+        }
+#endif
+    }
+}
+
+static void secp256k1_fe4_get_fe(secp256k1_fe_t *r, const secp256k1_fe4_t *a) {
+    int l;
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe4_get_lane(&r[l], a, l);
+    }
+}
+
+static void secp256k1_fe4_normalize_weak(secp256k1_fe4_t *r) {
+    int l;
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t t;
+        secp256k1_fe4_get_lane(&t, r, l);
+        secp256k1_fe_normalize_weak(&t);
+        secp256k1_fe4_set_lane(r, &t, l);
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+}
+
+static void secp256k1_fe4_normalize(secp256k1_fe4_t *r) {
+    int l;
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t t;
+        secp256k1_fe4_get_lane(&t, r, l);
+        secp256k1_fe_normalize(&t);
+        secp256k1_fe4_set_lane(r, &t, l);
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+}
+
+static void secp256k1_fe4_normalizes_to_zero(int *r, secp256k1_fe4_t *a) {
+    int l;
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t t;
+        secp256k1_fe4_get_lane(&t, a, l);
+        r[l] = secp256k1_fe_normalizes_to_zero(&t);
+    }
+}
+
+static void secp256k1_fe4_negate(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, int m) {
+#if defined(USE_FIELD_10X26)
+    int l;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= m);
+#endif
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t t;
+        secp256k1_fe4_get_lane(&t, a, l);
+        secp256k1_fe_negate(&t, &t, m);
+        secp256k1_fe4_set_lane(r, &t, l);
+    }
+#else
+    uint64_t m0 = 0xFFFFEFFFFFC2FULL * 2 * (m + 1), m1 = 0xFFFFFFFFFFFFFULL * 2 * (m + 1), m4 = 0x0FFFFFFFFFFFFULL * 2 * (m + 1);
+    int l;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= m);
+#endif
+    for (l = 0; l < 4; l++) {
+        r->n[0][l] = m0 - a->n[0][l];
+        r->n[1][l] = m1 - a->n[1][l];
+        r->n[2][l] = m1 - a->n[2][l];
+        r->n[3][l] = m1 - a->n[3][l];
+        r->n[4][l] = m4 - a->n[4][l];
+    }
+#endif
+#ifdef VERIFY
+    r->magnitude = m + 1;
+#endif
+}
+
+static void secp256k1_fe4_mul_int(secp256k1_fe4_t *r, int a) {
+    int i, l;
+    for (i = 0; i < SECP256K1_FE4_LIMBS; i++) {
+        for (l = 0; l < 4; l++) {
+            r->n[i][l] *= a;
+        }
+    }
+#ifdef VERIFY
+    r->magnitude *= a;
+#endif
+}
+
+static void secp256k1_fe4_add(secp256k1_fe4_t *r, const secp256k1_fe4_t *a) {
+    int i, l;
+    for (i = 0; i < SECP256K1_FE4_LIMBS; i++) {
+        for (l = 0; l < 4; l++) {
+            r->n[i][l] += a->n[i][l];
+        }
+    }
+#ifdef VERIFY
+    r->magnitude += a->magnitude;
+#endif
+}
+
+static void secp256k1_fe4_mul(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, const secp256k1_fe4_t *b) {
+    int l;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= 8);
+    VERIFY_CHECK(b->magnitude <= 8);
+#endif
+#if defined(USE_FIELD_4WAY_IFMA) && defined(USE_FIELD_5X52)
+    if (secp256k1_cpu_has(SECP256K1_CPU_IFMA)) {
+        secp256k1_fe4_mul_ifma(r, a, b);
+#ifdef VERIFY
+        r->magnitude = 1;
+#endif
+        return;
+    }
+#endif
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t x, y;
+        secp256k1_fe4_get_lane(&x, a, l);
+        secp256k1_fe4_get_lane(&y, b, l);
+        secp256k1_fe_mul(&x, &x, &y);
+        secp256k1_fe4_set_lane(r, &x, l);
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+}
+
+static void secp256k1_fe4_sqr(secp256k1_fe4_t *r, const secp256k1_fe4_t *a) {
+    int l;
+#ifdef VERIFY
+    VERIFY_CHECK(a->magnitude <= 8);
+#endif
+#if defined(USE_FIELD_4WAY_IFMA) && defined(USE_FIELD_5X52)
+    if (secp256k1_cpu_has(SECP256K1_CPU_IFMA)) {
+        secp256k1_fe4_sqr_ifma(r, a);
+#ifdef VERIFY
+        r->magnitude = 1;
+#endif
+        return;
+    }
+#endif
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_t x;
+        secp256k1_fe4_get_lane(&x, a, l);
+        secp256k1_fe_sqr(&x, &x);
+        secp256k1_fe4_set_lane(r, &x, l);
+    }
+#ifdef VERIFY
+    r->magnitude = 1;
+#endif
+}
+
+static void secp256k1_fe4_cmov(secp256k1_fe4_t *r, const secp256k1_fe4_t *a, const int *flag) {
+    secp256k1_fe4_limb_t mask0[4], mask1[4];
+    int i, l;
+    for (l = 0; l < 4; l++) {
+        VERIFY_CHECK(flag[l] == 0 || flag[l] == 1);
+        mask0[l] = flag[l] + ~((secp256k1_fe4_limb_t)0);
+        mask1[l] = ~mask0[l];
+    }
+    for (i = 0; i < SECP256K1_FE4_LIMBS; i++) {
+        for (l = 0; l < 4; l++) {
+            r->n[i][l] = (r->n[i][l] & mask0[l]) | (a->n[i][l] & mask1[l]);
+        }
+    }
+#ifdef VERIFY
+    if (a->magnitude > r->magnitude) {
+        r->magnitude = a->magnitude;
+    }
+#endif
+}
+
+#endif
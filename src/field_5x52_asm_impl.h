@@ -0,0 +1,449 @@
+/**********************************************************************
+ * Copyright (c) 2013, 2014 Pieter Wuille                             *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+/**
+ * Hand-scheduled x86_64 versions of secp256k1_fe_mul_inner and secp256k1_fe_sqr_inner. They follow
+ * the exact reduction strategy of field_5x52_int128_impl.h (see the comments there for the limb
+ * bounds), with the 128-bit accumulators c and d kept in register pairs:
+ *
+ *   rax,rdx  multiplier in/out
+ *   r8,r9    c (lo,hi)
+ *   r10,r11  d (lo,hi)
+ *   rcx      R = 0x1000003D10
+ *   r15      M = 0xFFFFFFFFFFFFF
+ *   r12-r14  r0-r2 (and temporaries)
+ *
+ * Output limbs are only stored once all input limbs have been read, so r may alias a.
+ */
+
+#ifndef _SECP256K1_FIELD_INNER5X52_IMPL_H_
+#define _SECP256K1_FIELD_INNER5X52_IMPL_H_
+
+#include <stdint.h>
+
+#ifdef VERIFY
+#define VERIFY_BITS(x, n) VERIFY_CHECK(((x) >> (n)) == 0)
+#else
+#define VERIFY_BITS(x, n) do { } while(0)
+#endif
+
+SECP256K1_INLINE static void secp256k1_fe_mul_inner(uint64_t *r, const uint64_t *a, const uint64_t * SECP256K1_RESTRICT b) {
+    uint64_t t3, t4;
+
+    VERIFY_BITS(a[0], 56);
+    VERIFY_BITS(a[1], 56);
+    VERIFY_BITS(a[2], 56);
+    VERIFY_BITS(a[3], 56);
+    VERIFY_BITS(a[4], 52);
+    VERIFY_BITS(b[0], 56);
+    VERIFY_BITS(b[1], 56);
+    VERIFY_BITS(b[2], 56);
+    VERIFY_BITS(b[3], 56);
+    VERIFY_BITS(b[4], 52);
+    VERIFY_CHECK(r != b);
+
+    __asm__ __volatile__(
+    "movq $0xFFFFFFFFFFFFF,%%r15\n"
+    "movq $0x1000003D10,%%rcx\n"
+    /* d = a0*b3 + a1*b2 + a2*b1 + a3*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "movq %%rax,%%r10\n"
+    "movq %%rdx,%%r11\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c = a4*b4 */
+    "movq 32(%%rsi),%%rax\n"
+    "mulq 32(%%rbx)\n"
+    "movq %%rax,%%r8\n"
+    "movq %%rdx,%%r9\n"
+    /* d += (c & M) * R; c >>= 52 */
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "shrdq $52,%%r9,%%r8\n"
+    /* t3 = d & M; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,%[t3]\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    /* d += a0*b4 + a1*b3 + a2*b2 + a3*b1 + a4*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 32(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 32(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* d += c * R */
+    "movq %%r8,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* t4 = d & M; d >>= 52; tx = t4 >> 48; t4 &= (M >> 4) */
+    "movq %%r10,%%r13\n"
+    "andq %%r15,%%r13\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    "movq %%r13,%%r14\n"
+    "shrq $48,%%r14\n"
+    "shlq $16,%%r13\n"
+    "shrq $16,%%r13\n"
+    "movq %%r13,%[t4]\n"
+    /* c = a0*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "movq %%rax,%%r8\n"
+    "movq %%rdx,%%r9\n"
+    /* d += a1*b4 + a2*b3 + a3*b2 + a4*b1 */
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 32(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 32(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* u0 = d & M; d >>= 52; u0 = (u0 << 4) | tx; c += u0 * (R >> 4) */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    "shlq $4,%%rax\n"
+    "orq %%r14,%%rax\n"
+    "movq $0x1000003D1,%%r14\n"
+    "mulq %%r14\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r0 = c & M; c >>= 52 */
+    "movq %%r8,%%r12\n"
+    "andq %%r15,%%r12\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0*b1 + a1*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a2*b4 + a3*b3 + a4*b2 */
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 32(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 32(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c += (d & M) * R; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    /* r1 = c & M; c >>= 52 */
+    "movq %%r8,%%r13\n"
+    "andq %%r15,%%r13\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += a0*b2 + a1*b1 + a2*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a3*b4 + a4*b3 */
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 32(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 32(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c += (d & M) * R; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "shrdq $52,%%r11,%%r10\n"
+    /* r2 = c & M; c >>= 52 */
+    "movq %%r8,%%r14\n"
+    "andq %%r15,%%r14\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* All of a has been read; store r0, r1, r2. */
+    "movq %%r12,0(%%rdi)\n"
+    "movq %%r13,8(%%rdi)\n"
+    "movq %%r14,16(%%rdi)\n"
+    /* c += d * R + t3 */
+    "movq %%r10,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "addq %[t3],%%r8\n"
+    "adcq $0,%%r9\n"
+    /* r3 = c & M; c >>= 52 */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    "shrdq $52,%%r9,%%r8\n"
+    /* r4 = c + t4 */
+    "addq %[t4],%%r8\n"
+    "movq %%r8,32(%%rdi)\n"
+    : [t3]"=m"(t3), [t4]"=m"(t4)
+    : "S"(a), "b"(b), "D"(r)
+    : "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+    );
+
+    VERIFY_BITS(r[0], 52);
+    VERIFY_BITS(r[1], 52);
+    VERIFY_BITS(r[2], 52);
+    VERIFY_BITS(r[3], 52);
+    VERIFY_BITS(r[4], 49);
+}
+
+SECP256K1_INLINE static void secp256k1_fe_sqr_inner(uint64_t *r, const uint64_t *a) {
+    uint64_t t3, t4;
+
+    VERIFY_BITS(a[0], 56);
+    VERIFY_BITS(a[1], 56);
+    VERIFY_BITS(a[2], 56);
+    VERIFY_BITS(a[3], 56);
+    VERIFY_BITS(a[4], 52);
+
+    __asm__ __volatile__(
+    "movq $0xFFFFFFFFFFFFF,%%r15\n"
+    "movq $0x1000003D10,%%rcx\n"
+    /* d = (a0*2)*a3 + (a1*2)*a2 */
+    "movq 0(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 24(%%rsi)\n"
+    "movq %%rax,%%r10\n"
+    "movq %%rdx,%%r11\n"
+    "movq 8(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 16(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c = a4*a4 */
+    "movq 32(%%rsi),%%rax\n"
+    "mulq %%rax\n"
+    "movq %%rax,%%r8\n"
+    "movq %%rdx,%%r9\n"
+    /* d += (c & M) * R; c >>= 52 */
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "shrdq $52,%%r9,%%r8\n"
+    /* t3 = d & M; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,%[t3]\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    /* d += a0*(a4*2) + (a1*2)*a3 + a2*a2 */
+    "movq 32(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 0(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 8(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 24(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq %%rax\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* d += c * R */
+    "movq %%r8,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* t4 = d & M; d >>= 52; tx = t4 >> 48; t4 &= (M >> 4) */
+    "movq %%r10,%%r13\n"
+    "andq %%r15,%%r13\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    "movq %%r13,%%r14\n"
+    "shrq $48,%%r14\n"
+    "shlq $16,%%r13\n"
+    "shrq $16,%%r13\n"
+    "movq %%r13,%[t4]\n"
+    /* c = a0*a0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq %%rax\n"
+    "movq %%rax,%%r8\n"
+    "movq %%rdx,%%r9\n"
+    /* d += a1*(a4*2) + (a2*2)*a3 */
+    "movq 32(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 8(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 16(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 24(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* u0 = d & M; d >>= 52; u0 = (u0 << 4) | tx; c += u0 * (R >> 4) */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    "shlq $4,%%rax\n"
+    "orq %%r14,%%rax\n"
+    "movq $0x1000003D1,%%r14\n"
+    "mulq %%r14\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* r0 = c & M; c >>= 52 */
+    "movq %%r8,%%r12\n"
+    "andq %%r15,%%r12\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += (a0*2)*a1 */
+    "movq 0(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 8(%%rsi)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a2*(a4*2) + a3*a3 */
+    "movq 32(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 16(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq %%rax\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c += (d & M) * R; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "shrdq $52,%%r11,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    /* r1 = c & M; c >>= 52 */
+    "movq %%r8,%%r13\n"
+    "andq %%r15,%%r13\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* c += (a0*2)*a2 + a1*a1 */
+    "movq 0(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 16(%%rsi)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq %%rax\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    /* d += a3*(a4*2) */
+    "movq 32(%%rsi),%%rax\n"
+    "addq %%rax,%%rax\n"
+    "mulq 24(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    /* c += (d & M) * R; d >>= 52 */
+    "movq %%r10,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "shrdq $52,%%r11,%%r10\n"
+    /* r2 = c & M; c >>= 52 */
+    "movq %%r8,%%r14\n"
+    "andq %%r15,%%r14\n"
+    "shrdq $52,%%r9,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    /* All of a has been read; store r0, r1, r2. */
+    "movq %%r12,0(%%rdi)\n"
+    "movq %%r13,8(%%rdi)\n"
+    "movq %%r14,16(%%rdi)\n"
+    /* c += d * R + t3 */
+    "movq %%r10,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "addq %[t3],%%r8\n"
+    "adcq $0,%%r9\n"
+    /* r3 = c & M; c >>= 52 */
+    "movq %%r8,%%rax\n"
+    "andq %%r15,%%rax\n"
+    "movq %%rax,24(%%rdi)\n"
+    "shrdq $52,%%r9,%%r8\n"
+    /* r4 = c + t4 */
+    "addq %[t4],%%r8\n"
+    "movq %%r8,32(%%rdi)\n"
+    : [t3]"=m"(t3), [t4]"=m"(t4)
+    : "S"(a), "D"(r)
+    : "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+    );
+
+    VERIFY_BITS(r[0], 52);
+    VERIFY_BITS(r[1], 52);
+    VERIFY_BITS(r[2], 52);
+    VERIFY_BITS(r[3], 52);
+    VERIFY_BITS(r[4], 49);
+}
+
+#endif
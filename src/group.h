@@ -62,6 +62,10 @@ static void secp256k1_ge_set_gej(secp256k1_ge_t *r, secp256k1_gej_t *a);
 /** Set a batch of group elements equal to the inputs given in jacobian coordinates */
 static void secp256k1_ge_set_all_gej_var(size_t len, secp256k1_ge_t *r, const secp256k1_gej_t *a);
 
+/** Like secp256k1_ge_set_all_gej_var, but constant time, using a single constant-time field inversion.
+ *  None of the inputs may be infinity. */
+static void secp256k1_ge_set_all_gej(size_t len, secp256k1_ge_t *r, const secp256k1_gej_t *a);
+
 /** Set a batch of group elements equal to the inputs given in jacobian
  *  coordinates (with known z-ratios). zr must contain the known z-ratios such
  *  that mul(a[i].z, zr[i+1]) == a[i+1].z. zr[0] is ignored. */
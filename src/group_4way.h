@@ -0,0 +1,49 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_GROUP_4WAY_
+#define _SECP256K1_GROUP_4WAY_
+
+#include "group.h"
+#include "field_4way.h"
+
+/** Four independent affine group elements, lane l of each coordinate belonging to point l. */
+typedef struct {
+    secp256k1_fe4_t x;
+    secp256k1_fe4_t y;
+    int infinity[4];
+} secp256k1_ge4_t;
+
+/** Four independent jacobian group elements. */
+typedef struct {
+    secp256k1_fe4_t x;
+    secp256k1_fe4_t y;
+    secp256k1_fe4_t z;
+    int infinity[4];
+} secp256k1_gej4_t;
+
+/** Load lane l of r from a[l], for l=0..3. */
+static void secp256k1_ge4_set_ge(secp256k1_ge4_t *r, const secp256k1_ge_t *a);
+
+/** Load lane l of r from a[l], for l=0..3. */
+static void secp256k1_gej4_set_gej(secp256k1_gej4_t *r, const secp256k1_gej_t *a);
+
+/** Store lane l of a in r[l], for l=0..3. */
+static void secp256k1_gej4_get_gej(secp256k1_gej_t *r, const secp256k1_gej4_t *a);
+
+/** Store lane l of a in r. */
+static void secp256k1_gej4_get_lane(secp256k1_gej_t *r, const secp256k1_gej4_t *a, int l);
+
+/** Replace lane l of r with a. */
+static void secp256k1_gej4_set_lane(secp256k1_gej4_t *r, const secp256k1_gej_t *a, int l);
+
+/** Lane-wise doubling, with the formula of secp256k1_gej_double_var but without branches. */
+static void secp256k1_gej4_double(secp256k1_gej4_t *r, const secp256k1_gej4_t *a);
+
+/** Lane-wise secp256k1_gej_add_ge: constant time, b must not contain infinity in any lane. */
+static void secp256k1_gej4_add_ge(secp256k1_gej4_t *r, const secp256k1_gej4_t *a, const secp256k1_ge4_t *b);
+
+#endif
@@ -0,0 +1,162 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_GROUP_4WAY_IMPL_H_
+#define _SECP256K1_GROUP_4WAY_IMPL_H_
+
+#include "group_4way.h"
+#include "group_impl.h"
+#include "field_4way_impl.h"
+
+static void secp256k1_ge4_set_ge(secp256k1_ge4_t *r, const secp256k1_ge_t *a) {
+    secp256k1_fe_t x[4], y[4];
+    int l;
+    for (l = 0; l < 4; l++) {
+        x[l] = a[l].x;
+        y[l] = a[l].y;
+        r->infinity[l] = a[l].infinity;
+    }
+    secp256k1_fe4_set_fe(&r->x, x);
+    secp256k1_fe4_set_fe(&r->y, y);
+}
+
+static void secp256k1_gej4_set_gej(secp256k1_gej4_t *r, const secp256k1_gej_t *a) {
+    secp256k1_fe_t x[4], y[4], z[4];
+    int l;
+    for (l = 0; l < 4; l++) {
+        x[l] = a[l].x;
+        y[l] = a[l].y;
+        z[l] = a[l].z;
+        r->infinity[l] = a[l].infinity;
+    }
+    secp256k1_fe4_set_fe(&r->x, x);
+    secp256k1_fe4_set_fe(&r->y, y);
+    secp256k1_fe4_set_fe(&r->z, z);
+}
+
+static void secp256k1_gej4_get_gej(secp256k1_gej_t *r, const secp256k1_gej4_t *a) {
+    secp256k1_fe_t x[4], y[4], z[4];
+    int l;
+    secp256k1_fe4_get_fe(x, &a->x);
+    secp256k1_fe4_get_fe(y, &a->y);
+    secp256k1_fe4_get_fe(z, &a->z);
+    for (l = 0; l < 4; l++) {
+        r[l].x = x[l];
+        r[l].y = y[l];
+        r[l].z = z[l];
+        r[l].infinity = a->infinity[l];
+    }
+}
+
+static void secp256k1_gej4_get_lane(secp256k1_gej_t *r, const secp256k1_gej4_t *a, int l) {
+    secp256k1_fe4_get_lane(&r->x, &a->x, l);
+    secp256k1_fe4_get_lane(&r->y, &a->y, l);
+    secp256k1_fe4_get_lane(&r->z, &a->z, l);
+    r->infinity = a->infinity[l];
+}
+
+static void secp256k1_gej4_set_lane(secp256k1_gej4_t *r, const secp256k1_gej_t *a, int l) {
+    secp256k1_fe4_set_lane_magnitude(&r->x, &a->x, l);
+    secp256k1_fe4_set_lane_magnitude(&r->y, &a->y, l);
+    secp256k1_fe4_set_lane_magnitude(&r->z, &a->z, l);
+    r->infinity[l] = a->infinity;
+}
+
+static void secp256k1_gej4_double(secp256k1_gej4_t *r, const secp256k1_gej4_t *a) {
+    /* Operations: 3 mul, 4 sqr, 0 normalize, 12 mul_int/add/negate */
+    secp256k1_fe4_t t1,t2,t3,t4;
+    int l;
+    /* 2Q is infinity if and only if Q is infinity (see secp256k1_gej_double_var); the coordinates of
+     * infinite lanes are computed like the others and ignored. */
+    for (l = 0; l < 4; l++) {
+        r->infinity[l] = a->infinity[l];
+    }
+
+    secp256k1_fe4_mul(&r->z, &a->z, &a->y);
+    secp256k1_fe4_mul_int(&r->z, 2);       /* Z' = 2*Y*Z (2) */
+    secp256k1_fe4_sqr(&t1, &a->x);
+    secp256k1_fe4_mul_int(&t1, 3);         /* T1 = 3*X^2 (3) */
+    secp256k1_fe4_sqr(&t2, &t1);           /* T2 = 9*X^4 (1) */
+    secp256k1_fe4_sqr(&t3, &a->y);
+    secp256k1_fe4_mul_int(&t3, 2);         /* T3 = 2*Y^2 (2) */
+    secp256k1_fe4_sqr(&t4, &t3);
+    secp256k1_fe4_mul_int(&t4, 2);         /* T4 = 8*Y^4 (2) */
+    secp256k1_fe4_mul(&t3, &t3, &a->x);    /* T3 = 2*X*Y^2 (1) */
+    r->x = t3;
+    secp256k1_fe4_mul_int(&r->x, 4);       /* X' = 8*X*Y^2 (4) */
+    secp256k1_fe4_negate(&r->x, &r->x, 4); /* X' = -8*X*Y^2 (5) */
+    secp256k1_fe4_add(&r->x, &t2);         /* X' = 9*X^4 - 8*X*Y^2 (6) */
+    secp256k1_fe4_negate(&t2, &t2, 1);     /* T2 = -9*X^4 (2) */
+    secp256k1_fe4_mul_int(&t3, 6);         /* T3 = 12*X*Y^2 (6) */
+    secp256k1_fe4_add(&t3, &t2);           /* T3 = 12*X*Y^2 - 9*X^4 (8) */
+    secp256k1_fe4_mul(&r->y, &t1, &t3);    /* Y' = 36*X^3*Y^2 - 27*X^6 (1) */
+    secp256k1_fe4_negate(&t2, &t4, 2);     /* T2 = -8*Y^4 (3) */
+    secp256k1_fe4_add(&r->y, &t2);         /* Y' = 36*X^3*Y^2 - 27*X^6 - 8*Y^4 (4) */
+}
+
+static void secp256k1_gej4_add_ge(secp256k1_gej4_t *r, const secp256k1_gej4_t *a, const secp256k1_ge4_t *b) {
+    /* Operations: 7 mul, 5 sqr, 5 normalize, 17 mul_int/add/negate/cmov */
+    static const secp256k1_fe_t fe_1[4] = {
+        SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1), SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1),
+        SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1), SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1)
+    };
+    secp256k1_fe4_t zz, u1, u2, s1, s2, z, t, m, n, q, rr, one;
+    int infinity[4];
+    int l;
+    for (l = 0; l < 4; l++) {
+        VERIFY_CHECK(!b->infinity[l]);
+        VERIFY_CHECK(a->infinity[l] == 0 || a->infinity[l] == 1);
+    }
+
+    /* See secp256k1_gej_add_ge for the derivation of this unified addition/doubling formula. Unlike
+     * there, lanes where a is infinity are not scaled by zero: they are overwritten by the final cmovs. */
+    secp256k1_fe4_sqr(&zz, &a->z);                      /* z = Z1^2 */
+    u1 = a->x; secp256k1_fe4_normalize_weak(&u1);       /* u1 = U1 = X1*Z2^2 (1) */
+    secp256k1_fe4_mul(&u2, &b->x, &zz);                 /* u2 = U2 = X2*Z1^2 (1) */
+    s1 = a->y; secp256k1_fe4_normalize_weak(&s1);       /* s1 = S1 = Y1*Z2^3 (1) */
+    secp256k1_fe4_mul(&s2, &b->y, &zz);                 /* s2 = Y2*Z2^2 (1) */
+    secp256k1_fe4_mul(&s2, &s2, &a->z);                 /* s2 = S2 = Y2*Z1^3 (1) */
+    z = a->z;                                           /* z = Z = Z1*Z2 (8) */
+    t = u1; secp256k1_fe4_add(&t, &u2);                 /* t = T = U1+U2 (2) */
+    m = s1; secp256k1_fe4_add(&m, &s2);                 /* m = M = S1+S2 (2) */
+    secp256k1_fe4_sqr(&n, &m);                          /* n = M^2 (1) */
+    secp256k1_fe4_mul(&q, &n, &t);                      /* q = Q = T*M^2 (1) */
+    secp256k1_fe4_sqr(&n, &n);                          /* n = M^4 (1) */
+    secp256k1_fe4_sqr(&rr, &t);                         /* rr = T^2 (1) */
+    secp256k1_fe4_mul(&t, &u1, &u2); secp256k1_fe4_negate(&t, &t, 1); /* t = -U1*U2 (2) */
+    secp256k1_fe4_add(&rr, &t);                                       /* rr = R = T^2-U1*U2 (3) */
+    secp256k1_fe4_sqr(&t, &rr);                                       /* t = R^2 (1) */
+    secp256k1_fe4_mul(&r->z, &m, &z);                                 /* r->z = M*Z (1) */
+    secp256k1_fe4_normalizes_to_zero(infinity, &r->z);
+    for (l = 0; l < 4; l++) {
+        infinity[l] *= 1 - a->infinity[l];
+    }
+    secp256k1_fe4_mul_int(&r->z, 2);                    /* r->z = Z3 = 2*M*Z (2) */
+    r->x = t;                                           /* r->x = R^2 (1) */
+    secp256k1_fe4_negate(&q, &q, 1);                    /* q = -Q (2) */
+    secp256k1_fe4_add(&r->x, &q);                       /* r->x = R^2-Q (3) */
+    secp256k1_fe4_normalize(&r->x);
+    secp256k1_fe4_mul_int(&q, 3);                       /* q = -3*Q (6) */
+    secp256k1_fe4_mul_int(&t, 2);                       /* t = 2*R^2 (2) */
+    secp256k1_fe4_add(&t, &q);                          /* t = 2*R^2-3*Q (8) */
+    secp256k1_fe4_mul(&t, &t, &rr);                     /* t = R*(2*R^2-3*Q) (1) */
+    secp256k1_fe4_add(&t, &n);                          /* t = R*(2*R^2-3*Q)+M^4 (2) */
+    secp256k1_fe4_negate(&r->y, &t, 2);                 /* r->y = R*(3*Q-2*R^2)-M^4 (3) */
+    secp256k1_fe4_normalize_weak(&r->y);
+    secp256k1_fe4_mul_int(&r->x, 4);                    /* r->x = X3 = 4*(R^2-Q) */
+    secp256k1_fe4_mul_int(&r->y, 4);                    /* r->y = Y3 = 4*R*(3*Q-2*R^2)-4*M^4 (4) */
+
+    /* Lanes where a is infinity become (b->x, b->y, 1). */
+    secp256k1_fe4_set_fe(&one, fe_1);
+    secp256k1_fe4_cmov(&r->x, &b->x, a->infinity);
+    secp256k1_fe4_cmov(&r->y, &b->y, a->infinity);
+    secp256k1_fe4_cmov(&r->z, &one, a->infinity);
+    for (l = 0; l < 4; l++) {
+        r->infinity[l] = infinity[l];
+    }
+}
+
+#endif
@@ -20,6 +20,24 @@ static void secp256k1_sha256_initialize(secp256k1_sha256_t *hash);
 static void secp256k1_sha256_write(secp256k1_sha256_t *hash, const unsigned char *data, size_t size);
 static void secp256k1_sha256_finalize(secp256k1_sha256_t *hash, unsigned char *out32);
 
+/** Up to this many independent SHA-256 streams of equal length can be hashed in lockstep. */
+#define SECP256K1_SHA256_MAX_LANES 8
+
+typedef struct {
+    uint32_t s[SECP256K1_SHA256_MAX_LANES][8];
+    uint32_t buf[SECP256K1_SHA256_MAX_LANES][16]; /* In big endian */
+    size_t bytes;
+    int lanes;
+} secp256k1_sha256_multi_t;
+
+static void secp256k1_sha256_multi_initialize(secp256k1_sha256_multi_t *hash, int lanes);
+/** Appends size bytes from data[i] to lane i, for each lane. */
+static void secp256k1_sha256_multi_write(secp256k1_sha256_multi_t *hash, const unsigned char * const *data, size_t size);
+/** Appends the same size bytes to every lane. */
+static void secp256k1_sha256_multi_write_common(secp256k1_sha256_multi_t *hash, const unsigned char *data, size_t size);
+/** Writes the 32-byte hash of lane i to out32s + 32 * i. */
+static void secp256k1_sha256_multi_finalize(secp256k1_sha256_multi_t *hash, unsigned char *out32s);
+
 typedef struct {
     secp256k1_sha256_t inner, outer;
 } secp256k1_hmac_sha256_t;
@@ -30,7 +48,7 @@ static void secp256k1_hmac_sha256_finalize(secp256k1_hmac_sha256_t *hash, unsign
 
 typedef struct {
     unsigned char v[32];
-    unsigned char k[32];
+    secp256k1_hmac_sha256_t k; /* HMAC keyed with K, so the key blocks are only compressed when K changes. */
     int retry;
 } secp256k1_rfc6979_hmac_sha256_t;
 
@@ -7,6 +7,8 @@
 #ifndef _SECP256K1_HASH_IMPL_H_
 #define _SECP256K1_HASH_IMPL_H_
 
+#include "util.h"
+#include "cpu.h"
 #include "hash.h"
 
 #include <stdlib.h>
@@ -33,6 +35,13 @@
 #define BE32(p) ((((p) & 0xFF) << 24) | (((p) & 0xFF00) << 8) | (((p) & 0xFF0000) >> 8) | (((p) & 0xFF000000) >> 24))
 #endif
 
+#if defined(USE_SHA256_SHANI)
+#include "hash_shani_impl.h"
+#endif
+#if defined(USE_SHA256_SIMD)
+#include "hash_simd_impl.h"
+#endif
+
 static void secp256k1_sha256_initialize(secp256k1_sha256_t *hash) {
     hash->s[0] = 0x6a09e667ul;
     hash->s[1] = 0xbb67ae85ul;
@@ -46,7 +55,7 @@ static void secp256k1_sha256_initialize(secp256k1_sha256_t *hash) {
 }
 
 /** Perform one SHA-256 transformation, processing 16 big endian 32-bit words. */
-static void secp256k1_sha256_transform(uint32_t* s, const uint32_t* chunk) {
+static void secp256k1_sha256_transform_c(uint32_t* s, const uint32_t* chunk) {
     uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
     uint32_t w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
 
@@ -128,6 +137,16 @@ static void secp256k1_sha256_transform(uint32_t* s, const uint32_t* chunk) {
     s[7] += h;
 }
 
+static void secp256k1_sha256_transform(uint32_t* s, const uint32_t* chunk) {
+#if defined(USE_SHA256_SHANI)
+    if (secp256k1_cpu_has(SECP256K1_CPU_SHANI)) {
+        secp256k1_sha256_transform_shani(s, chunk);
+        return;
+    }
+#endif
+    secp256k1_sha256_transform_c(s, chunk);
+}
+
 static void secp256k1_sha256_write(secp256k1_sha256_t *hash, const unsigned char *data, size_t len) {
     size_t bufsize = hash->bytes & 0x3F;
     hash->bytes += len;
@@ -161,6 +180,97 @@ static void secp256k1_sha256_finalize(secp256k1_sha256_t *hash, unsigned char *o
     memcpy(out32, (const unsigned char*)out, 32);
 }
 
+static void secp256k1_sha256_multi_initialize(secp256k1_sha256_multi_t *hash, int lanes) {
+    int l;
+    VERIFY_CHECK(lanes > 0 && lanes <= SECP256K1_SHA256_MAX_LANES);
+    /* Unused lanes are initialized too, as the vector transforms always process whole groups of lanes. */
+    for (l = 0; l < SECP256K1_SHA256_MAX_LANES; l++) {
+        secp256k1_sha256_t sha256;
+        secp256k1_sha256_initialize(&sha256);
+        memcpy(hash->s[l], sha256.s, sizeof(hash->s[l]));
+    }
+    memset(hash->buf, 0, sizeof(hash->buf));
+    hash->bytes = 0;
+    hash->lanes = lanes;
+}
+
+static void secp256k1_sha256_multi_transform(secp256k1_sha256_multi_t *hash) {
+    int l;
+#if defined(USE_SHA256_SIMD)
+    int simd = 1;
+#if defined(USE_SHA256_SHANI)
+    /* One SHA-NI compression per lane beats both interleaved transforms. */
+    simd = !secp256k1_cpu_has(SECP256K1_CPU_SHANI);
+#endif
+    if (simd) {
+        if (secp256k1_cpu_has(SECP256K1_CPU_AVX2) && hash->lanes > 4) {
+            secp256k1_sha256_transform_8way(hash->s, hash->buf);
+            return;
+        }
+        if (hash->lanes > 2) {
+            for (l = 0; l < hash->lanes; l += 4) {
+                secp256k1_sha256_transform_4way(&hash->s[l], &hash->buf[l]);
+            }
+            return;
+        }
+    }
+#endif
+    for (l = 0; l < hash->lanes; l++) {
+        secp256k1_sha256_transform(hash->s[l], hash->buf[l]);
+    }
+}
+
+static void secp256k1_sha256_multi_write(secp256k1_sha256_multi_t *hash, const unsigned char * const *data, size_t len) {
+    size_t bufsize = hash->bytes & 0x3F;
+    size_t done = 0;
+    int l;
+    hash->bytes += len;
+    while (bufsize + len >= 64) {
+        /* Fill the buffers, and process them. */
+        for (l = 0; l < hash->lanes; l++) {
+            memcpy(((unsigned char*)hash->buf[l]) + bufsize, data[l] + done, 64 - bufsize);
+        }
+        done += 64 - bufsize;
+        len -= 64 - bufsize;
+        secp256k1_sha256_multi_transform(hash);
+        bufsize = 0;
+    }
+    if (len) {
+        /* Fill the buffers with what remains. */
+        for (l = 0; l < hash->lanes; l++) {
+            memcpy(((unsigned char*)hash->buf[l]) + bufsize, data[l] + done, len);
+        }
+    }
+}
+
+static void secp256k1_sha256_multi_write_common(secp256k1_sha256_multi_t *hash, const unsigned char *data, size_t len) {
+    const unsigned char *ptrs[SECP256K1_SHA256_MAX_LANES];
+    int l;
+    for (l = 0; l < hash->lanes; l++) {
+        ptrs[l] = data;
+    }
+    secp256k1_sha256_multi_write(hash, ptrs, len);
+}
+
+static void secp256k1_sha256_multi_finalize(secp256k1_sha256_multi_t *hash, unsigned char *out32s) {
+    static const unsigned char pad[64] = {0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    uint32_t sizedesc[2];
+    uint32_t out[8];
+    int i;
+    int l;
+    sizedesc[0] = BE32(hash->bytes >> 29);
+    sizedesc[1] = BE32(hash->bytes << 3);
+    secp256k1_sha256_multi_write_common(hash, pad, 1 + ((119 - (hash->bytes % 64)) % 64));
+    secp256k1_sha256_multi_write_common(hash, (const unsigned char*)sizedesc, 8);
+    for (l = 0; l < hash->lanes; l++) {
+        for (i = 0; i < 8; i++) {
+            out[i] = BE32(hash->s[l][i]);
+            hash->s[l][i] = 0;
+        }
+        memcpy(out32s + 32 * l, (const unsigned char*)out, 32);
+    }
+}
+
 static void secp256k1_hmac_sha256_initialize(secp256k1_hmac_sha256_t *hash, const unsigned char *key, size_t keylen) {
     int n;
     unsigned char rkey[64];
@@ -204,14 +314,15 @@ static void secp256k1_hmac_sha256_finalize(secp256k1_hmac_sha256_t *hash, unsign
 
 static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha256_t *rng, const unsigned char *key, size_t keylen, const unsigned char *msg, size_t msglen, const unsigned char *rnd, size_t rndlen) {
     secp256k1_hmac_sha256_t hmac;
+    unsigned char k[32];
     static const unsigned char zero[1] = {0x00};
     static const unsigned char one[1] = {0x01};
 
     memset(rng->v, 0x01, 32); /* RFC6979 3.2.b. */
-    memset(rng->k, 0x00, 32); /* RFC6979 3.2.c. */
+    memset(k, 0x00, 32); /* RFC6979 3.2.c. */
 
     /* RFC6979 3.2.d. */
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+    secp256k1_hmac_sha256_initialize(&hmac, k, 32);
     secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
     secp256k1_hmac_sha256_write(&hmac, zero, 1);
     secp256k1_hmac_sha256_write(&hmac, key, keylen);
@@ -220,13 +331,14 @@ static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha2
         /* RFC6979 3.6 "Additional data". */
         secp256k1_hmac_sha256_write(&hmac, rnd, rndlen);
     }
-    secp256k1_hmac_sha256_finalize(&hmac, rng->k);
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+    secp256k1_hmac_sha256_finalize(&hmac, k);
+    secp256k1_hmac_sha256_initialize(&rng->k, k, 32);
+    hmac = rng->k;
     secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
     secp256k1_hmac_sha256_finalize(&hmac, rng->v);
 
     /* RFC6979 3.2.f. */
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+    hmac = rng->k;
     secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
     secp256k1_hmac_sha256_write(&hmac, one, 1);
     secp256k1_hmac_sha256_write(&hmac, key, keylen);
@@ -235,10 +347,12 @@ static void secp256k1_rfc6979_hmac_sha256_initialize(secp256k1_rfc6979_hmac_sha2
         /* RFC6979 3.6 "Additional data". */
         secp256k1_hmac_sha256_write(&hmac, rnd, rndlen);
     }
-    secp256k1_hmac_sha256_finalize(&hmac, rng->k);
-    secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+    secp256k1_hmac_sha256_finalize(&hmac, k);
+    secp256k1_hmac_sha256_initialize(&rng->k, k, 32);
+    hmac = rng->k;
     secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
     secp256k1_hmac_sha256_finalize(&hmac, rng->v);
+    memset(k, 0, 32);
     rng->retry = 0;
 }
 
@@ -247,19 +361,22 @@ static void secp256k1_rfc6979_hmac_sha256_generate(secp256k1_rfc6979_hmac_sha256
     static const unsigned char zero[1] = {0x00};
     if (rng->retry) {
         secp256k1_hmac_sha256_t hmac;
-        secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+        unsigned char k[32];
+        hmac = rng->k;
         secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
         secp256k1_hmac_sha256_write(&hmac, zero, 1);
-        secp256k1_hmac_sha256_finalize(&hmac, rng->k);
-        secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
+        secp256k1_hmac_sha256_finalize(&hmac, k);
+        secp256k1_hmac_sha256_initialize(&rng->k, k, 32);
+        memset(k, 0, 32);
+        hmac = rng->k;
         secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
         secp256k1_hmac_sha256_finalize(&hmac, rng->v);
     }
 
     while (outlen > 0) {
-        secp256k1_hmac_sha256_t hmac;
+        /* Only the blocks holding V and the inner hash remain to be compressed. */
+        secp256k1_hmac_sha256_t hmac = rng->k;
         int now = outlen;
-        secp256k1_hmac_sha256_initialize(&hmac, rng->k, 32);
         secp256k1_hmac_sha256_write(&hmac, rng->v, 32);
         secp256k1_hmac_sha256_finalize(&hmac, rng->v);
         if (now > 32) {
@@ -274,7 +391,7 @@ static void secp256k1_rfc6979_hmac_sha256_generate(secp256k1_rfc6979_hmac_sha256
 }
 
 static void secp256k1_rfc6979_hmac_sha256_finalize(secp256k1_rfc6979_hmac_sha256_t *rng) {
-    memset(rng->k, 0, 32);
+    memset(&rng->k, 0, sizeof(rng->k));
     memset(rng->v, 0, 32);
     rng->retry = 0;
 }
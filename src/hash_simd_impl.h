@@ -0,0 +1,136 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_HASH_SIMD_IMPL_H_
+#define _SECP256K1_HASH_SIMD_IMPL_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+/* Vertical SHA-256: lane l of every vector holds a word of stream l, so 4 (SSE2) or 8 (AVX2) independent
+ * blocks are compressed by one instruction stream. Callers pass exactly that many lanes of state and message. */
+
+static const uint32_t secp256k1_sha256_simd_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* The bitwise operations are named per width, everything else is shared through the intrinsic prefix. */
+#define SIMD_OR__mm _mm_or_si128
+#define SIMD_AND__mm _mm_and_si128
+#define SIMD_XOR__mm _mm_xor_si128
+#define SIMD_OR__mm256 _mm256_or_si256
+#define SIMD_AND__mm256 _mm256_and_si256
+#define SIMD_XOR__mm256 _mm256_xor_si256
+#define SIMD_OR(p) SIMD_OR_##p
+#define SIMD_AND(p) SIMD_AND_##p
+#define SIMD_XOR(p) SIMD_XOR_##p
+
+#define SIMD_ROTR(p, x, n) SIMD_OR(p)(p##_srli_epi32((x), (n)), p##_slli_epi32((x), 32 - (n)))
+#define SIMD_Ch(p, x, y, z) SIMD_XOR(p)((z), SIMD_AND(p)((x), SIMD_XOR(p)((y), (z))))
+#define SIMD_Maj(p, x, y, z) SIMD_OR(p)(SIMD_AND(p)((x), (y)), SIMD_AND(p)((z), SIMD_OR(p)((x), (y))))
+#define SIMD_Sigma0(p, x) SIMD_XOR(p)(SIMD_XOR(p)(SIMD_ROTR(p, x, 2), SIMD_ROTR(p, x, 13)), SIMD_ROTR(p, x, 22))
+#define SIMD_Sigma1(p, x) SIMD_XOR(p)(SIMD_XOR(p)(SIMD_ROTR(p, x, 6), SIMD_ROTR(p, x, 11)), SIMD_ROTR(p, x, 25))
+#define SIMD_sigma0(p, x) SIMD_XOR(p)(SIMD_XOR(p)(SIMD_ROTR(p, x, 7), SIMD_ROTR(p, x, 18)), p##_srli_epi32((x), 3))
+#define SIMD_sigma1(p, x) SIMD_XOR(p)(SIMD_XOR(p)(SIMD_ROTR(p, x, 17), SIMD_ROTR(p, x, 19)), p##_srli_epi32((x), 10))
+
+__attribute__((target("sse2")))
+static void secp256k1_sha256_transform_4way(uint32_t (*s)[8], uint32_t (*chunk)[16]) {
+    __m128i w[16];
+    __m128i v[8];
+    __m128i a, b, c, d, e, f, g, h, t1, t2;
+    uint32_t out[4][8];
+    int i;
+    int l;
+    for (i = 0; i < 8; i++) {
+        v[i] = _mm_set_epi32(s[3][i], s[2][i], s[1][i], s[0][i]);
+    }
+    a = v[0]; b = v[1]; c = v[2]; d = v[3]; e = v[4]; f = v[5]; g = v[6]; h = v[7];
+    for (i = 0; i < 64; i++) {
+        if (i < 16) {
+            w[i] = _mm_set_epi32(BE32(chunk[3][i]), BE32(chunk[2][i]), BE32(chunk[1][i]), BE32(chunk[0][i]));
+        } else {
+            w[i & 15] = _mm_add_epi32(_mm_add_epi32(SIMD_sigma1(_mm, w[(i - 2) & 15]), w[(i - 7) & 15]),
+             _mm_add_epi32(SIMD_sigma0(_mm, w[(i - 15) & 15]), w[i & 15]));
+        }
+        t1 = _mm_add_epi32(_mm_add_epi32(h, SIMD_Sigma1(_mm, e)), _mm_add_epi32(SIMD_Ch(_mm, e, f, g),
+         _mm_add_epi32(_mm_set1_epi32(secp256k1_sha256_simd_k[i]), w[i & 15])));
+        t2 = _mm_add_epi32(SIMD_Sigma0(_mm, a), SIMD_Maj(_mm, a, b, c));
+        h = g; g = f; f = e; e = _mm_add_epi32(d, t1); d = c; c = b; b = a; a = _mm_add_epi32(t1, t2);
+    }
+    v[0] = _mm_add_epi32(v[0], a); v[1] = _mm_add_epi32(v[1], b); v[2] = _mm_add_epi32(v[2], c); v[3] = _mm_add_epi32(v[3], d);
+    v[4] = _mm_add_epi32(v[4], e); v[5] = _mm_add_epi32(v[5], f); v[6] = _mm_add_epi32(v[6], g); v[7] = _mm_add_epi32(v[7], h);
+    for (i = 0; i < 8; i++) {
+        uint32_t tmp[4];
+        _mm_storeu_si128((__m128i*)tmp, v[i]);
+        for (l = 0; l < 4; l++) {
+            out[l][i] = tmp[l];
+        }
+    }
+    memcpy(s, out, sizeof(out));
+}
+
+__attribute__((target("avx2")))
+static void secp256k1_sha256_transform_8way(uint32_t (*s)[8], uint32_t (*chunk)[16]) {
+    __m256i w[16];
+    __m256i v[8];
+    __m256i a, b, c, d, e, f, g, h, t1, t2;
+    uint32_t out[8][8];
+    int i;
+    int l;
+    for (i = 0; i < 8; i++) {
+        v[i] = _mm256_set_epi32(s[7][i], s[6][i], s[5][i], s[4][i], s[3][i], s[2][i], s[1][i], s[0][i]);
+    }
+    a = v[0]; b = v[1]; c = v[2]; d = v[3]; e = v[4]; f = v[5]; g = v[6]; h = v[7];
+    for (i = 0; i < 64; i++) {
+        if (i < 16) {
+            w[i] = _mm256_set_epi32(BE32(chunk[7][i]), BE32(chunk[6][i]), BE32(chunk[5][i]), BE32(chunk[4][i]), BE32(chunk[3][i]), BE32(chunk[2][i]), BE32(chunk[1][i]), BE32(chunk[0][i]));
+        } else {
+            w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(SIMD_sigma1(_mm256, w[(i - 2) & 15]), w[(i - 7) & 15]),
+             _mm256_add_epi32(SIMD_sigma0(_mm256, w[(i - 15) & 15]), w[i & 15]));
+        }
+        t1 = _mm256_add_epi32(_mm256_add_epi32(h, SIMD_Sigma1(_mm256, e)), _mm256_add_epi32(SIMD_Ch(_mm256, e, f, g),
+         _mm256_add_epi32(_mm256_set1_epi32(secp256k1_sha256_simd_k[i]), w[i & 15])));
+        t2 = _mm256_add_epi32(SIMD_Sigma0(_mm256, a), SIMD_Maj(_mm256, a, b, c));
+        h = g; g = f; f = e; e = _mm256_add_epi32(d, t1); d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+    }
+    v[0] = _mm256_add_epi32(v[0], a); v[1] = _mm256_add_epi32(v[1], b); v[2] = _mm256_add_epi32(v[2], c); v[3] = _mm256_add_epi32(v[3], d);
+    v[4] = _mm256_add_epi32(v[4], e); v[5] = _mm256_add_epi32(v[5], f); v[6] = _mm256_add_epi32(v[6], g); v[7] = _mm256_add_epi32(v[7], h);
+    for (i = 0; i < 8; i++) {
+        uint32_t tmp[8];
+        _mm256_storeu_si256((__m256i*)tmp, v[i]);
+        for (l = 0; l < 8; l++) {
+            out[l][i] = tmp[l];
+        }
+    }
+    memcpy(s, out, sizeof(out));
+}
+
+#undef SIMD_ROTR
+#undef SIMD_Ch
+#undef SIMD_Maj
+#undef SIMD_Sigma0
+#undef SIMD_Sigma1
+#undef SIMD_sigma0
+#undef SIMD_sigma1
+#undef SIMD_OR__mm
+#undef SIMD_AND__mm
+#undef SIMD_XOR__mm
+#undef SIMD_OR__mm256
+#undef SIMD_AND__mm256
+#undef SIMD_XOR__mm256
+#undef SIMD_OR
+#undef SIMD_AND
+#undef SIMD_XOR
+
+#endif
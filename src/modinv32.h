@@ -0,0 +1,39 @@
+/**********************************************************************
+ * Copyright (c) 2020 Peter Dettman                                   *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODINV32_
+#define _SECP256K1_MODINV32_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+/* A signed 30-bit limb representation of integers.
+ *
+ * Its value is sum(v[i] * 2^(30*i), i=0..8). */
+typedef struct {
+    int32_t v[9];
+} secp256k1_modinv32_signed30_t;
+
+typedef struct {
+    /* The modulus in signed30 notation, must be odd and in [3, 2^256]. */
+    secp256k1_modinv32_signed30_t modulus;
+
+    /* modulus^{-1} mod 2^30 */
+    uint32_t modulus_inv30;
+} secp256k1_modinv32_modinfo_t;
+
+/** Replace x with its modular inverse mod modinfo->modulus, using the safegcd (Bernstein-Yang
+ *  divstep) algorithm. x must be in range [0, modulus), with limbs in [0, 2^30). If x is zero,
+ *  the result is zero. Runs in constant time. */
+static void secp256k1_modinv32(secp256k1_modinv32_signed30_t *x, const secp256k1_modinv32_modinfo_t *modinfo);
+
+/** Same as secp256k1_modinv32, but variable time: only use for public inputs. */
+static void secp256k1_modinv32_var(secp256k1_modinv32_signed30_t *x, const secp256k1_modinv32_modinfo_t *modinfo);
+
+#endif
@@ -0,0 +1,43 @@
+/**********************************************************************
+ * Copyright (c) 2020 Peter Dettman                                   *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_MODINV64_
+#define _SECP256K1_MODINV64_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+#ifndef HAVE___INT128
+#error "modinv64 requires 128-bit wide multiplication support"
+#endif
+
+/* A signed 62-bit limb representation of integers.
+ *
+ * Its value is sum(v[i] * 2^(62*i), i=0..4). */
+typedef struct {
+    int64_t v[5];
+} secp256k1_modinv64_signed62_t;
+
+typedef struct {
+    /* The modulus in signed62 notation, must be odd and in [3, 2^256]. */
+    secp256k1_modinv64_signed62_t modulus;
+
+    /* modulus^{-1} mod 2^62 */
+    uint64_t modulus_inv62;
+} secp256k1_modinv64_modinfo_t;
+
+/** Replace x with its modular inverse mod modinfo->modulus, using the safegcd (Bernstein-Yang
+ *  divstep) algorithm. x must be in range [0, modulus), with limbs in [0, 2^62). If x is zero,
+ *  the result is zero. Runs in constant time. */
+static void secp256k1_modinv64(secp256k1_modinv64_signed62_t *x, const secp256k1_modinv64_modinfo_t *modinfo);
+
+/** Same as secp256k1_modinv64, but variable time: only use for public inputs. */
+static void secp256k1_modinv64_var(secp256k1_modinv64_signed62_t *x, const secp256k1_modinv64_modinfo_t *modinfo);
+
+#endif
@@ -0,0 +1,83 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_PARALLEL_
+#define _SECP256K1_PARALLEL_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+
+/* Sequentially consistent atomic operations (configure checks that the builtins exist). */
+# define SECP256K1_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+# define SECP256K1_ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+# define SECP256K1_ATOMIC_EXCHANGE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+# define SECP256K1_ATOMIC_ADD(p, v) __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+# define SECP256K1_ATOMIC_SUB(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_SEQ_CST)
+/* If *p equals *expected, replace it with desired and return 1; otherwise load it into *expected and return 0. */
+# define SECP256K1_ATOMIC_CAS(p, expected, desired) __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+#endif
+
+/** The items a worker has left: [head, tail). The owner takes from the head and thieves take
+ *  from the tail. Items are never added after the start, so a deque is just a range. */
+typedef struct {
+    size_t head;
+    size_t tail;
+#ifdef USE_PTHREADS
+    pthread_mutex_t lock;
+#endif
+} secp256k1_parallel_deque_t;
+
+/** Runs process(data, worker, begin, end) on ranges of at most grain items that together cover
+ *  every i in [0, n) exactly once, spread over workers that steal from each other when they run out. */
+typedef struct {
+    secp256k1_parallel_deque_t *deques;
+    int nworkers;
+    size_t grain;
+    void (*process)(void *data, int worker, size_t begin, size_t end);
+    void *data;
+} secp256k1_parallel_t;
+
+/** Split [0, n) evenly over nworkers (at least 1) workers, to be handed out grain (at least 1) items
+ *  at a time. Without USE_PTHREADS, nworkers must be 1. */
+static void secp256k1_parallel_init(secp256k1_parallel_t *par, int nworkers, size_t n, size_t grain, void (*process)(void *data, int worker, size_t begin, size_t end), void *data);
+
+static void secp256k1_parallel_clear(secp256k1_parallel_t *par);
+
+/** The body of worker number worker of the secp256k1_parallel_t at arg (so a secp256k1_parallel_task_t):
+ *  process its own items, then steal until every deque is empty. */
+static void secp256k1_parallel_worker(void *arg, int worker);
+
+/** Run all workers: worker 0 on the calling thread and the others on threads of their own.
+ *  If a thread cannot be started, the remaining workers take over its items. */
+static void secp256k1_parallel_run(secp256k1_parallel_t *par);
+
+#ifdef USE_PTHREADS
+/** A queue of jobs that any number of threads push to without taking a lock, while one thread at
+ *  a time pops (Vyukov's intrusive MPSC queue). Jobs are linked through their reserved field, and
+ *  the queue must not move after secp256k1_job_queue_init. */
+typedef struct {
+    secp256k1_verify_job_t *head; /* the last job pushed; producers swap themselves in here */
+    secp256k1_verify_job_t *tail; /* the next job to pop; only the consumer uses it */
+    secp256k1_verify_job_t stub;  /* keeps the list non-empty */
+} secp256k1_job_queue_t;
+
+static void secp256k1_job_queue_init(secp256k1_job_queue_t *q);
+
+static void secp256k1_job_queue_push(secp256k1_job_queue_t *q, secp256k1_verify_job_t *job);
+
+/** Returns the oldest job, or NULL if there is none or if the push of the one after it has
+ *  not finished yet (in which case it shortly will). */
+static secp256k1_verify_job_t *secp256k1_job_queue_pop(secp256k1_job_queue_t *q);
+#endif
+
+#endif
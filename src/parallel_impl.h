@@ -0,0 +1,189 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_PARALLEL_IMPL_H_
+#define _SECP256K1_PARALLEL_IMPL_H_
+
+#include "parallel.h"
+
+#ifdef USE_PTHREADS
+# define SECP256K1_PARALLEL_LOCK(d) CHECK(pthread_mutex_lock(&(d)->lock) == 0)
+# define SECP256K1_PARALLEL_UNLOCK(d) CHECK(pthread_mutex_unlock(&(d)->lock) == 0)
+#else
+# define SECP256K1_PARALLEL_LOCK(d) ((void)(d))
+# define SECP256K1_PARALLEL_UNLOCK(d) ((void)(d))
+#endif
+
+static void secp256k1_parallel_init(secp256k1_parallel_t *par, int nworkers, size_t n, size_t grain, void (*process)(void *data, int worker, size_t begin, size_t end), void *data) {
+    int w;
+    VERIFY_CHECK(nworkers >= 1);
+    VERIFY_CHECK(grain >= 1);
+#ifndef USE_PTHREADS
+    VERIFY_CHECK(nworkers == 1);
+#endif
+    par->deques = (secp256k1_parallel_deque_t *)checked_malloc(sizeof(secp256k1_parallel_deque_t) * nworkers);
+    par->nworkers = nworkers;
+    par->grain = grain;
+    par->process = process;
+    par->data = data;
+    for (w = 0; w < nworkers; w++) {
+        par->deques[w].head = n * w / nworkers;
+        par->deques[w].tail = n * (w + 1) / nworkers;
+#ifdef USE_PTHREADS
+        CHECK(pthread_mutex_init(&par->deques[w].lock, NULL) == 0);
+#endif
+    }
+}
+
+static void secp256k1_parallel_clear(secp256k1_parallel_t *par) {
+#ifdef USE_PTHREADS
+    int w;
+    for (w = 0; w < par->nworkers; w++) {
+        pthread_mutex_destroy(&par->deques[w].lock);
+    }
+#endif
+    free(par->deques);
+    par->deques = NULL;
+}
+
+/* Take up to grain items off the head of d, if it has any. */
+static int secp256k1_parallel_pop(secp256k1_parallel_deque_t *d, size_t grain, size_t *begin, size_t *end) {
+    int ret = 0;
+    SECP256K1_PARALLEL_LOCK(d);
+    if (d->head < d->tail) {
+        *begin = d->head;
+        d->head += grain < d->tail - d->head ? grain : d->tail - d->head;
+        *end = d->head;
+        ret = 1;
+    }
+    SECP256K1_PARALLEL_UNLOCK(d);
+    return ret;
+}
+
+/* Move the back half (rounded up) of some other worker's items into the empty deque of worker. */
+static int secp256k1_parallel_steal(secp256k1_parallel_t *par, int worker) {
+    int k;
+    for (k = 1; k < par->nworkers; k++) {
+        secp256k1_parallel_deque_t *victim = &par->deques[(worker + k) % par->nworkers];
+        size_t begin = 0, end = 0;
+        SECP256K1_PARALLEL_LOCK(victim);
+        if (victim->head < victim->tail) {
+            end = victim->tail;
+            begin = victim->tail - (victim->tail - victim->head + 1) / 2;
+            victim->tail = begin;
+        }
+        SECP256K1_PARALLEL_UNLOCK(victim);
+        if (begin < end) {
+            secp256k1_parallel_deque_t *own = &par->deques[worker];
+            SECP256K1_PARALLEL_LOCK(own);
+            own->head = begin;
+            own->tail = end;
+            SECP256K1_PARALLEL_UNLOCK(own);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void secp256k1_parallel_worker(void *arg, int worker) {
+    secp256k1_parallel_t *par = (secp256k1_parallel_t *)arg;
+    size_t begin, end;
+    DEBUG_CHECK(worker >= 0 && worker < par->nworkers);
+    do {
+        while (secp256k1_parallel_pop(&par->deques[worker], par->grain, &begin, &end)) {
+            par->process(par->data, worker, begin, end);
+        }
+    } while (secp256k1_parallel_steal(par, worker));
+}
+
+#ifdef USE_PTHREADS
+typedef struct {
+    secp256k1_parallel_t *par;
+    int worker;
+} secp256k1_parallel_thread_t;
+
+static void *secp256k1_parallel_thread_main(void *arg) {
+    secp256k1_parallel_thread_t *t = (secp256k1_parallel_thread_t *)arg;
+    secp256k1_parallel_worker(t->par, t->worker);
+    return NULL;
+}
+#endif
+
+static void secp256k1_parallel_run(secp256k1_parallel_t *par) {
+#ifdef USE_PTHREADS
+    if (par->nworkers > 1) {
+        pthread_t *threads = (pthread_t *)checked_malloc(sizeof(pthread_t) * (par->nworkers - 1));
+        secp256k1_parallel_thread_t *args = (secp256k1_parallel_thread_t *)checked_malloc(sizeof(secp256k1_parallel_thread_t) * (par->nworkers - 1));
+        int *started = (int *)checked_malloc(sizeof(int) * (par->nworkers - 1));
+        int w;
+        for (w = 1; w < par->nworkers; w++) {
+            args[w - 1].par = par;
+            args[w - 1].worker = w;
+            started[w - 1] = pthread_create(&threads[w - 1], NULL, secp256k1_parallel_thread_main, &args[w - 1]) == 0;
+        }
+        secp256k1_parallel_worker(par, 0);
+        for (w = 1; w < par->nworkers; w++) {
+            if (started[w - 1]) {
+                CHECK(pthread_join(threads[w - 1], NULL) == 0);
+            }
+        }
+        free(started);
+        free(args);
+        free(threads);
+        return;
+    }
+#endif
+    secp256k1_parallel_worker(par, 0);
+}
+
+#ifdef USE_PTHREADS
+static void secp256k1_job_queue_init(secp256k1_job_queue_t *q) {
+    q->stub.reserved = NULL;
+    q->head = &q->stub;
+    q->tail = &q->stub;
+}
+
+static void secp256k1_job_queue_push(secp256k1_job_queue_t *q, secp256k1_verify_job_t *job) {
+    secp256k1_verify_job_t *prev;
+    SECP256K1_ATOMIC_STORE(&job->reserved, NULL);
+    prev = SECP256K1_ATOMIC_EXCHANGE(&q->head, job);
+    /* Until this store, consumers see the list end at prev. */
+    SECP256K1_ATOMIC_STORE(&prev->reserved, (void *)job);
+}
+
+static secp256k1_verify_job_t *secp256k1_job_queue_pop(secp256k1_job_queue_t *q) {
+    secp256k1_verify_job_t *tail = q->tail;
+    secp256k1_verify_job_t *next = (secp256k1_verify_job_t *)SECP256K1_ATOMIC_LOAD(&tail->reserved);
+    if (tail == &q->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        q->tail = next;
+        tail = next;
+        next = (secp256k1_verify_job_t *)SECP256K1_ATOMIC_LOAD(&tail->reserved);
+    }
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != SECP256K1_ATOMIC_LOAD(&q->head)) {
+        return NULL;
+    }
+    /* tail is the last job; put the stub behind it so it can be handed out. */
+    secp256k1_job_queue_push(q, &q->stub);
+    next = (secp256k1_verify_job_t *)SECP256K1_ATOMIC_LOAD(&tail->reserved);
+    if (next != NULL) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+#endif
+
+#undef SECP256K1_PARALLEL_LOCK
+#undef SECP256K1_PARALLEL_UNLOCK
+
+#endif
@@ -9,20 +9,50 @@
 
 #include "scalar.h"
 #include "group.h"
+#include "scratch.h"
 
 typedef struct {
     secp256k1_ge_storage_t (*prec)[1005];
 } secp256k1_rangeproof_context_t;
 
 
+static const size_t SECP256K1_RANGEPROOF_CONTEXT_TABLE_SIZE = ROUND_TO_ALIGN(sizeof(secp256k1_ge_storage_t) * 1005);
+
 static void secp256k1_rangeproof_context_init(secp256k1_rangeproof_context_t* ctx);
-static void secp256k1_rangeproof_context_build(secp256k1_rangeproof_context_t* ctx);
+/** Build the basis in memory carved off *prealloc (SECP256K1_RANGEPROOF_CONTEXT_TABLE_SIZE bytes). */
+static void secp256k1_rangeproof_context_build(secp256k1_rangeproof_context_t* ctx, void **prealloc);
 static void secp256k1_rangeproof_context_clone(secp256k1_rangeproof_context_t *dst,
-                                               const secp256k1_rangeproof_context_t* src);
+                                               const secp256k1_rangeproof_context_t* src, void **prealloc);
 static void secp256k1_rangeproof_context_clear(secp256k1_rangeproof_context_t* ctx);
 static int secp256k1_rangeproof_context_is_built(const secp256k1_rangeproof_context_t* ctx);
 
-static int secp256k1_rangeproof_verify_impl(const secp256k1_ecmult_context_t* ecmult_ctx,
+/* The large temporaries of signing, verifying and rewinding, which they draw from a scratch space. */
+typedef struct {
+    secp256k1_gej_t pubs[128];     /* Candidate digits for our proof, most inferred. */
+    secp256k1_scalar_t s[128];     /* Signatures in our proof, most forged. */
+    secp256k1_scalar_t sec[32];    /* Blinding factors for the correct digits. */
+    secp256k1_scalar_t k[32];      /* Nonces for our non-forged signatures. */
+    unsigned char prep[4096];
+} secp256k1_rangeproof_sign_frame_t;
+
+typedef struct {
+    secp256k1_gej_t pubs[128];
+    secp256k1_scalar_t s[128];
+    secp256k1_scalar_t evalues[128]; /* Challenges, only used during proof rewind. */
+} secp256k1_rangeproof_verify_frame_t;
+
+typedef struct {
+    secp256k1_scalar_t s_orig[128];
+    secp256k1_scalar_t sec[32];
+    unsigned char prep[4096];
+} secp256k1_rangeproof_rewind_frame_t;
+
+/** The most scratch space one sign, verify, rewind or rewind check draws; verifying with a nonce rewinds too. */
+#define SECP256K1_RANGEPROOF_SCRATCH_SIZE \
+    (ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_sign_frame_t)) > ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_verify_frame_t)) + ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_rewind_frame_t)) ? \
+     ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_sign_frame_t)) : ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_verify_frame_t)) + ROUND_TO_ALIGN(sizeof(secp256k1_rangeproof_rewind_frame_t)))
+
+static int secp256k1_rangeproof_verify_impl(secp256k1_scratch_space_t *scratch, const secp256k1_ecmult_context_t* ecmult_ctx,
  const secp256k1_ecmult_gen_context_t* ecmult_gen_ctx,
  const secp256k1_ecmult_gen2_context_t* ecmult_gen2_ctx, const secp256k1_rangeproof_context_t* rangeproof_ctx,
  unsigned char *blindout, uint64_t *value_out, unsigned char *message_out, int *outlen, const unsigned char *nonce,
@@ -10,6 +10,7 @@
 #include "scalar.h"
 #include "group.h"
 #include "rangeproof.h"
+#include "scratch_impl.h"
 #include "hash_impl.h"
 
 static const int secp256k1_rangeproof_offsets[20] = {
@@ -22,47 +23,54 @@ static void secp256k1_rangeproof_context_init(secp256k1_rangeproof_context_t *ct
     ctx->prec = NULL;
 }
 
-static void secp256k1_rangeproof_context_build(secp256k1_rangeproof_context_t *ctx) {
-    secp256k1_ge_t *prec;
-    secp256k1_gej_t *precj;
+/* Convert n Jacobian points of the basis, starting at index pos, to storage form. */
+static void secp256k1_rangeproof_context_store(secp256k1_rangeproof_context_t *ctx, int pos, const secp256k1_gej_t *precj, int n) {
+    secp256k1_ge_t prec[96];
+    int i;
+    secp256k1_ge_set_all_gej_var(n, prec, precj);
+    for (i = 0; i < n; i++) {
+        secp256k1_ge_to_storage(&(*ctx->prec)[pos + i], &prec[i]);
+    }
+}
+
+static void secp256k1_rangeproof_context_build(secp256k1_rangeproof_context_t *ctx, void **prealloc) {
+    secp256k1_gej_t precj[96]; /* Jacobian versions of the most recent prec entries; a multiple of 3. */
     secp256k1_gej_t gj;
     secp256k1_gej_t one;
-    int i, pos;
+    int i, pos, n;
 
     if (ctx->prec != NULL) {
         return;
     }
 
-    precj = (secp256k1_gej_t (*))checked_malloc(sizeof(*precj) * 1005);
-    if (precj == NULL) {
-        return;
-    }
-    prec = (secp256k1_ge_t (*))checked_malloc(sizeof(*prec) * 1005);
-    if (prec == NULL) {
-        free(precj);
-        return;
-    }
+    ctx->prec = (secp256k1_ge_storage_t (*)[1005])manual_alloc(prealloc, sizeof(*ctx->prec));
 
     /* get the generator */
     secp256k1_gej_set_ge(&one, &secp256k1_ge_const_g2);
     secp256k1_gej_neg(&one, &one);
 
-    /* compute prec. */
+    /* compute prec, in batches of 96 (every digit position contributes a multiple of 3 entries). */
     pos = 0;
+    n = 0;
     for (i = 0; i < 19; i++) {
         int pmax;
         pmax = secp256k1_rangeproof_offsets[i + 1];
         gj = one;
         while (pos < pmax) {
-            precj[pos] = gj;
+            if (n == 96) {
+                secp256k1_rangeproof_context_store(ctx, pos - n, precj, n);
+                n = 0;
+            }
+            precj[n] = gj;
             pos++;
-            secp256k1_gej_double_var(&precj[pos], &gj, NULL);
+            secp256k1_gej_double_var(&precj[n + 1], &gj, NULL);
             pos++;
-            secp256k1_gej_add_var(&precj[pos], &precj[pos - 1], &gj, NULL);
+            secp256k1_gej_add_var(&precj[n + 2], &precj[n + 1], &gj, NULL);
             pos++;
             if (pos < pmax - 1) {
-                secp256k1_gej_double_var(&gj, &precj[pos - 2], NULL);
+                secp256k1_gej_double_var(&gj, &precj[n + 1], NULL);
             }
+            n += 3;
         }
         if (i < 18) {
             secp256k1_gej_double_var(&gj, &one, NULL);
@@ -73,39 +81,24 @@ static void secp256k1_rangeproof_context_build(secp256k1_rangeproof_context_t *c
         }
     }
     VERIFY_CHECK(pos == 1005);
-    secp256k1_ge_set_all_gej_var(1005, prec, precj);
-
-    free(precj);
-
-    ctx->prec = (secp256k1_ge_storage_t (*)[1005])checked_malloc(sizeof(*ctx->prec));
-    if (ctx->prec == NULL) {
-        free(prec);
-        return;
-    }
-
-    for (i = 0; i < 1005; i++) {
-        secp256k1_ge_to_storage(&(*ctx->prec)[i], &prec[i]);
-    }
-    free(prec);
+    secp256k1_rangeproof_context_store(ctx, pos - n, precj, n);
 }
 
-
 static int secp256k1_rangeproof_context_is_built(const secp256k1_rangeproof_context_t* ctx) {
     return ctx->prec != NULL;
 }
 
 static void secp256k1_rangeproof_context_clone(secp256k1_rangeproof_context_t *dst,
-                                               const secp256k1_rangeproof_context_t *src) {
+                                               const secp256k1_rangeproof_context_t *src, void **prealloc) {
     if (src->prec == NULL) {
         dst->prec = NULL;
     } else {
-        dst->prec = (secp256k1_ge_storage_t (*)[1005])checked_malloc(sizeof(*dst->prec));
+        dst->prec = (secp256k1_ge_storage_t (*)[1005])manual_alloc(prealloc, sizeof(*dst->prec));
         memcpy(dst->prec, src->prec, sizeof(*dst->prec));
     }
 }
 
 static void secp256k1_rangeproof_context_clear(secp256k1_rangeproof_context_t *ctx) {
-    free(ctx->prec);
     ctx->prec = NULL;
 }
 
@@ -177,6 +170,48 @@ SECP256K1_INLINE static int secp256k1_rangeproof_genrand(secp256k1_scalar_t *sec
     return ret;
 }
 
+/** Writes v as a bijective base-128 varint (most significant group first, every byte but the last has its top
+ *  bit set and the groups are offset by one so that each value has exactly one encoding). Returns bytes written, at most 10.
+ */
+SECP256K1_INLINE static int secp256k1_rangeproof_varint_write(unsigned char *out, uint64_t v) {
+    unsigned char tmp[10];
+    int len;
+    int i;
+    len = 0;
+    while (1) {
+        tmp[len] = (v & 127) | (len ? 128 : 0);
+        if (v <= 127) {
+            break;
+        }
+        v = (v >> 7) - 1;
+        len++;
+    }
+    for (i = 0; i <= len; i++) {
+        out[i] = tmp[len - i];
+    }
+    return len + 1;
+}
+
+SECP256K1_INLINE static int secp256k1_rangeproof_varint_read(uint64_t *v, const unsigned char *proof, int *offset, int plen) {
+    unsigned char ch;
+    *v = 0;
+    do {
+        if (*offset >= plen || *v > (UINT64_MAX >> 7)) {
+            return 0;
+        }
+        ch = proof[*offset];
+        *offset += 1;
+        *v = (*v << 7) | (ch & 127);
+        if (ch & 128) {
+            if (*v == UINT64_MAX) {
+                return 0;
+            }
+            *v += 1;
+        }
+    } while (ch & 128);
+    return 1;
+}
+
 SECP256K1_INLINE static int secp256k1_range_proveparams(uint64_t *v, int *rings, int *rsizes, int *npub, int *secidx, uint64_t *min_value,
  int *mantissa, uint64_t *scale,  int *exp, int *min_bits, uint64_t value) {
     int i;
@@ -254,18 +289,21 @@ SECP256K1_INLINE static int secp256k1_range_proveparams(uint64_t *v, int *rings,
     return 1;
 }
 
-/* strawman interface, writes proof in proof, a buffer of plen, proves with respect to min_value the range for commit which has the provided blinding factor and value. */
-SECP256K1_INLINE static int secp256k1_rangeproof_sign_impl(const secp256k1_ecmult_context_t* ecmult_ctx,
+/* strawman interface, writes proof in proof, a buffer of plen, proves with respect to min_value the range for commit which has the provided blinding factor and value.
+ * If compact is set a non-zero min_value is written as a varint and flagged with the top bit of the header byte. */
+SECP256K1_INLINE static int secp256k1_rangeproof_sign_impl(secp256k1_scratch_space_t *scratch, const secp256k1_ecmult_context_t* ecmult_ctx,
  const secp256k1_ecmult_gen_context_t* ecmult_gen_ctx, const secp256k1_ecmult_gen2_context_t* ecmult_gen2_ctx,
  const secp256k1_rangeproof_context_t* rangeproof_ctx, unsigned char *proof, int *plen, uint64_t min_value,
- const unsigned char *commit, const unsigned char *blind, const unsigned char *nonce, int exp, int min_bits, uint64_t value){
-    secp256k1_gej_t pubs[128];     /* Candidate digits for our proof, most inferred. */
-    secp256k1_scalar_t s[128];     /* Signatures in our proof, most forged. */
-    secp256k1_scalar_t sec[32];    /* Blinding factors for the correct digits. */
-    secp256k1_scalar_t k[32];      /* Nonces for our non-forged signatures. */
+ const unsigned char *commit, const unsigned char *blind, const unsigned char *nonce, int exp, int min_bits, uint64_t value,
+ int compact){
+    secp256k1_rangeproof_sign_frame_t *frame;
+    secp256k1_gej_t *pubs;
+    secp256k1_scalar_t *s;
+    secp256k1_scalar_t *sec;
+    secp256k1_scalar_t *k;
+    unsigned char *prep;
     secp256k1_scalar_t stmp;
     secp256k1_sha256_t sha256_m;
-    unsigned char prep[4096];
     unsigned char tmp[33];
     unsigned char *signs;          /* Location of sign flags in the proof. */
     uint64_t v;
@@ -285,14 +323,26 @@ SECP256K1_INLINE static int secp256k1_rangeproof_sign_impl(const secp256k1_ecmul
     if (!secp256k1_range_proveparams(&v, &rings, rsizes, &npub, secidx, &min_value, &mantissa, &scale, &exp, &min_bits, value)) {
         return 0;
     }
-    proof[len] = (rsizes[0] > 1 ? (64 | exp) : 0) | (min_value ? 32 : 0);
+    frame = (secp256k1_rangeproof_sign_frame_t *)secp256k1_scratch_alloc(scratch, sizeof(*frame));
+    if (frame == NULL) {
+        return 0;
+    }
+    pubs = frame->pubs;
+    s = frame->s;
+    sec = frame->sec;
+    k = frame->k;
+    prep = frame->prep;
+    compact = compact && min_value;
+    proof[len] = (compact ? 128 : 0) | (rsizes[0] > 1 ? (64 | exp) : 0) | (min_value ? 32 : 0);
     len++;
     if (rsizes[0] > 1) {
         VERIFY_CHECK(mantissa > 0 && mantissa <= 64);
         proof[len] = mantissa - 1;
         len++;
     }
-    if (min_value) {
+    if (compact) {
+        len += secp256k1_rangeproof_varint_write(&proof[len], min_value);
+    } else if (min_value) {
         for (i = 0; i < 8; i++) {
             proof[len + i] = (min_value >> ((7-i) * 8)) & 255;
         }
@@ -384,13 +434,14 @@ SECP256K1_INLINE static int secp256k1_rangeproof_sign_impl(const secp256k1_ecmul
     return 1;
 }
 
-/* Computes blinding factor x given k, s, and the challenge e. */
+/* Computes blinding factor x given k, s, and the challenge e. The challenge is a hash of public proof data, so it
+ * is inverted in variable time. */
 SECP256K1_INLINE static void secp256k1_rangeproof_recover_x(secp256k1_scalar_t *x, const secp256k1_scalar_t *k, const secp256k1_scalar_t *e,
  const secp256k1_scalar_t *s) {
     secp256k1_scalar_t stmp;
     secp256k1_scalar_negate(x, s);
     secp256k1_scalar_add(x, x, k);
-    secp256k1_scalar_inverse(&stmp, e);
+    secp256k1_scalar_inverse_var(&stmp, e);
     secp256k1_scalar_mul(x, x, &stmp);
 }
 
@@ -409,13 +460,14 @@ SECP256K1_INLINE static void secp256k1_rangeproof_ch32xor(unsigned char *x, cons
     }
 }
 
-SECP256K1_INLINE static int secp256k1_rangeproof_rewind_inner(secp256k1_scalar_t *blind, uint64_t *v,
+SECP256K1_INLINE static int secp256k1_rangeproof_rewind_inner(secp256k1_scratch_space_t *scratch, secp256k1_scalar_t *blind, uint64_t *v,
  unsigned char *m, int *mlen, secp256k1_scalar_t *ev, secp256k1_scalar_t *s,
  int *rsizes, int rings, const unsigned char *nonce, const unsigned char *commit, const unsigned char *proof, int len) {
-    secp256k1_scalar_t s_orig[128];
-    secp256k1_scalar_t sec[32];
+    secp256k1_rangeproof_rewind_frame_t *frame;
+    secp256k1_scalar_t *s_orig;
+    secp256k1_scalar_t *sec;
+    unsigned char *prep;
     secp256k1_scalar_t stmp;
-    unsigned char prep[4096];
     unsigned char tmp[32];
     uint64_t value;
     int offset;
@@ -425,6 +477,13 @@ SECP256K1_INLINE static int secp256k1_rangeproof_rewind_inner(secp256k1_scalar_t
     int skip1;
     int skip2;
     int npub;
+    frame = (secp256k1_rangeproof_rewind_frame_t *)secp256k1_scratch_alloc(scratch, sizeof(*frame));
+    if (frame == NULL) {
+        return 0;
+    }
+    s_orig = frame->s_orig;
+    sec = frame->sec;
+    prep = frame->prep;
     npub = ((rings - 1) << 2) + rsizes[rings-1];
     VERIFY_CHECK(npub <= 128);
     VERIFY_CHECK(npub >= 1);
@@ -535,13 +594,19 @@ SECP256K1_INLINE static int secp256k1_rangeproof_rewind_inner(secp256k1_scalar_t
 SECP256K1_INLINE static int secp256k1_rangeproof_getheader_impl(int *offset, int *exp, int *mantissa, uint64_t *scale,
  uint64_t *min_value, uint64_t *max_value, const unsigned char *proof, int plen) {
     int i;
+    int has_compact_min;
     int has_nz_range;
     int has_min;
-    if (plen < 65 || ((proof[*offset] & 128) != 0)) {
+    if (plen < 65) {
         return 0;
     }
+    has_compact_min = proof[*offset] & 128;
     has_nz_range = proof[*offset] & 64;
     has_min = proof[*offset] & 32;
+    if (has_compact_min && !has_min) {
+        /* The compact flag only has a meaning for the min_value field, so reject it elsewhere. */
+        return 0;
+    }
     *exp = -1;
     *mantissa = 0;
     if (has_nz_range) {
@@ -568,11 +633,14 @@ SECP256K1_INLINE static int secp256k1_rangeproof_getheader_impl(int *offset, int
         *scale *= 10;
     }
     *min_value = 0;
-    if (has_min) {
+    if (has_compact_min) {
+        if (!secp256k1_rangeproof_varint_read(min_value, proof, offset, plen)) {
+            return 0;
+        }
+    } else if (has_min) {
         if(plen - *offset < 8) {
             return 0;
         }
-        /*FIXME: Compact minvalue encoding?*/
         for (i = 0; i < 8; i++) {
             *min_value = (*min_value << 8) | proof[*offset + i];
         }
@@ -585,17 +653,134 @@ SECP256K1_INLINE static int secp256k1_rangeproof_getheader_impl(int *offset, int
     return 1;
 }
 
+/* Computes the ring layout implied by a header's mantissa, as used by both the verifier and the rewinder. */
+SECP256K1_INLINE static void secp256k1_rangeproof_rsizes(int *rsizes, int *rings, int *npub, int mantissa) {
+    int i;
+    *rings = 1;
+    rsizes[0] = 1;
+    *npub = 1;
+    if (mantissa != 0) {
+        *rings = (mantissa >> 1);
+        for (i = 0; i < *rings; i++) {
+            rsizes[i] = 4;
+        }
+        *npub = (mantissa >> 1) << 2;
+        if (mantissa & 1) {
+            rsizes[*rings] = 2;
+            *npub += rsizes[*rings];
+            (*rings)++;
+        }
+    }
+    VERIFY_CHECK(*rings <= 32);
+}
+
+/* Decodes only the header of a proof to find its ring layout and the exact length the verifier requires. */
+SECP256K1_INLINE static int secp256k1_rangeproof_cost_impl(int *rings, int *npub, int *explen, const unsigned char *proof, int plen) {
+    uint64_t min_value;
+    uint64_t max_value;
+    uint64_t scale;
+    int rsizes[32];
+    int exp;
+    int mantissa;
+    int offset;
+    offset = 0;
+    if (!secp256k1_rangeproof_getheader_impl(&offset, &exp, &mantissa, &scale, &min_value, &max_value, proof, plen)) {
+        return 0;
+    }
+    secp256k1_rangeproof_rsizes(rsizes, rings, npub, mantissa);
+    /* Sign bits, blinded digit commitments, e0 and one s value per public key. */
+    *explen = offset + ((*rings + 6) >> 3) + 32 * (*rings - 1) + 32 + 32 * *npub;
+    return 1;
+}
+
+/** Checks whether nonce could rewind proof without doing any curve operations: regenerates the prover's random stream
+ *  and looks for the value encoding in the last ring, exactly as secp256k1_rangeproof_rewind_inner does. Returns 0 if
+ *  the proof was certainly not created with this nonce (or is malformed), 1 if a full rewind should be attempted.
+ */
+SECP256K1_INLINE static int secp256k1_rangeproof_rewind_check_impl(secp256k1_scratch_space_t *scratch, const unsigned char *nonce,
+ const unsigned char *commit, const unsigned char *proof, int plen) {
+    secp256k1_rangeproof_rewind_frame_t *frame;
+    secp256k1_scalar_t *s_orig;
+    secp256k1_scalar_t *sec;
+    unsigned char *prep;
+    unsigned char tmp[32];
+    uint64_t min_value;
+    uint64_t max_value;
+    uint64_t scale;
+    uint64_t value;
+    int rsizes[32];
+    int exp;
+    int mantissa;
+    int offset;
+    int offset_s;
+    int rings;
+    int npub;
+    int ret;
+    int i;
+    int j;
+    offset = 0;
+    if (!secp256k1_rangeproof_getheader_impl(&offset, &exp, &mantissa, &scale, &min_value, &max_value, proof, plen)) {
+        return 0;
+    }
+    secp256k1_rangeproof_rsizes(rsizes, &rings, &npub, mantissa);
+    if (plen - offset < 32 * (npub + rings - 1) + 32 + ((rings+6) >> 3)) {
+        return 0;
+    }
+    if (rings == 1 && rsizes[0] == 1) {
+        /* Exact value proofs carry no value encoding, only a full rewind can tell. */
+        return 1;
+    }
+    frame = (secp256k1_rangeproof_rewind_frame_t *)secp256k1_scratch_alloc(scratch, sizeof(*frame));
+    if (frame == NULL) {
+        return 0;
+    }
+    s_orig = frame->s_orig;
+    sec = frame->sec;
+    prep = frame->prep;
+    /* Skip the sign bits, the blinded digit commitments and e0 to reach the s values. */
+    offset_s = offset + ((rings + 6) >> 3) + 32 * (rings - 1) + 32;
+    memset(prep, 0, 4096);
+    secp256k1_rangeproof_genrand(sec, s_orig, prep, rsizes, rings, nonce, commit, proof, offset);
+    ret = 0;
+    npub = (rings - 1) << 2;
+    for (j = 0; j < 2; j++) {
+        int idx;
+        idx = npub + rsizes[rings - 1] - 1 - j;
+        memcpy(tmp, &proof[offset_s + idx * 32], 32);
+        secp256k1_rangeproof_ch32xor(tmp, &prep[idx * 32]);
+        if ((tmp[0] & 128) && (memcmp(&tmp[16], &tmp[24], 8) == 0) && (memcmp(&tmp[8], &tmp[16], 8) == 0)) {
+            value = 0;
+            for (i = 0; i < 8; i++) {
+                value = (value << 8) + tmp[24 + i];
+            }
+            /* The encoding must not sit in the slot of the real digit. */
+            ret = (rsizes[rings - 1] - 1 - j) != (int)((value >> ((rings - 1) << 1)) & 3);
+            break;
+        }
+    }
+    memset(prep, 0, 4096);
+    memset(tmp, 0, 32);
+    for (i = 0; i < 128; i++) {
+        secp256k1_scalar_clear(&s_orig[i]);
+    }
+    for (i = 0; i < 32; i++) {
+        secp256k1_scalar_clear(&sec[i]);
+    }
+    return ret;
+}
+
 /* Verifies range proof (len plen) for 33-byte commit, the min/max values proven are put in the min/max arguments; returns 0 on failure 1 on success.*/
-SECP256K1_INLINE static int secp256k1_rangeproof_verify_impl(const secp256k1_ecmult_context_t* ecmult_ctx,
+SECP256K1_INLINE static int secp256k1_rangeproof_verify_impl(secp256k1_scratch_space_t *scratch, const secp256k1_ecmult_context_t* ecmult_ctx,
  const secp256k1_ecmult_gen_context_t* ecmult_gen_ctx,
  const secp256k1_ecmult_gen2_context_t* ecmult_gen2_ctx, const secp256k1_rangeproof_context_t* rangeproof_ctx,
  unsigned char *blindout, uint64_t *value_out, unsigned char *message_out, int *outlen, const unsigned char *nonce,
  uint64_t *min_value, uint64_t *max_value, const unsigned char *commit, const unsigned char *proof, int plen) {
+    secp256k1_rangeproof_verify_frame_t *frame;
     secp256k1_gej_t accj;
-    secp256k1_gej_t pubs[128];
+    secp256k1_gej_t *pubs;
     secp256k1_ge_t c;
-    secp256k1_scalar_t s[128];
-    secp256k1_scalar_t evalues[128]; /* Challenges, only used during proof rewind. */
+    secp256k1_scalar_t *s;
+    secp256k1_scalar_t *evalues;
     secp256k1_sha256_t sha256_m;
     int rsizes[32];
     int ret;
@@ -616,25 +801,17 @@ SECP256K1_INLINE static int secp256k1_rangeproof_verify_impl(const secp256k1_ecm
         return 0;
     }
     offset_post_header = offset;
-    rings = 1;
-    rsizes[0] = 1;
-    npub = 1;
-    if (mantissa != 0) {
-        rings = (mantissa >> 1);
-        for (i = 0; i < rings; i++) {
-            rsizes[i] = 4;
-        }
-        npub = (mantissa >> 1) << 2;
-        if (mantissa & 1) {
-            rsizes[rings] = 2;
-            npub += rsizes[rings];
-            rings++;
-        }
-    }
-    VERIFY_CHECK(rings <= 32);
+    secp256k1_rangeproof_rsizes(rsizes, &rings, &npub, mantissa);
     if (plen - offset < 32 * (npub + rings - 1) + 32 + ((rings+6) >> 3)) {
         return 0;
     }
+    frame = (secp256k1_rangeproof_verify_frame_t *)secp256k1_scratch_alloc(scratch, sizeof(*frame));
+    if (frame == NULL) {
+        return 0;
+    }
+    pubs = frame->pubs;
+    s = frame->s;
+    evalues = frame->evalues;
     secp256k1_sha256_initialize(&sha256_m);
     secp256k1_sha256_write(&sha256_m, commit, 33);
     secp256k1_sha256_write(&sha256_m, proof, offset);
@@ -698,7 +875,7 @@ SECP256K1_INLINE static int secp256k1_rangeproof_verify_impl(const secp256k1_ecm
         if (!ecmult_gen_ctx) {
             return 0;
         }
-        if (!secp256k1_rangeproof_rewind_inner(&blind, &vv, message_out, outlen, evalues, s, rsizes, rings, nonce, commit, proof, offset_post_header)) {
+        if (!secp256k1_rangeproof_rewind_inner(scratch, &blind, &vv, message_out, outlen, evalues, s, rsizes, rings, nonce, commit, proof, offset_post_header)) {
             return 0;
         }
         /* Unwind apparently successful, see if the commitment can be reconstructed. */
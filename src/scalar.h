@@ -13,7 +13,13 @@
 #include "libsecp256k1-config.h"
 #endif
 
+#if defined(USE_SCALAR_8X32)
+#include "scalar_8x32.h"
+#elif defined(USE_SCALAR_4X64)
 #include "scalar_4x64.h"
+#else
+#error "Please select scalar implementation"
+#endif
 
 /** Clear a scalar to prevent the leak of sensitive data. */
 static void secp256k1_scalar_clear(secp256k1_scalar_t *r);
@@ -55,6 +61,16 @@ static void secp256k1_scalar_inverse(secp256k1_scalar_t *r, const secp256k1_scal
 /** Compute the inverse of a scalar (modulo the group order), without constant-time guarantee. */
 static void secp256k1_scalar_inverse_var(secp256k1_scalar_t *r, const secp256k1_scalar_t *a);
 
+/** Calculate the inverses of a batch of nonzero scalars (modulo the group order), without
+ *  constant-time guarantee. This costs one inversion and 3(len-1) multiplications. r and a must not
+ *  overlap. */
+static void secp256k1_scalar_inv_all_var(size_t len, secp256k1_scalar_t *r, const secp256k1_scalar_t *a);
+
+/** Like secp256k1_scalar_inv_all_var, but constant time. The product of the inputs is multiplied by
+ *  the secret, nonzero blind before the one inversion, and divided out again afterwards, so that
+ *  inversion never sees the product itself. Costs 3len multiplications. */
+static void secp256k1_scalar_inv_all(size_t len, secp256k1_scalar_t *r, const secp256k1_scalar_t *a, const secp256k1_scalar_t *blind);
+
 /** Compute the complement of a scalar (modulo the group order). */
 static void secp256k1_scalar_negate(secp256k1_scalar_t *r, const secp256k1_scalar_t *a);
 
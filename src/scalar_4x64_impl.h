@@ -7,6 +7,9 @@
 #ifndef _SECP256K1_SCALAR_REPR_IMPL_H_
 #define _SECP256K1_SCALAR_REPR_IMPL_H_
 
+#include "cpu.h"
+#include "modinv64_impl.h"
+
 /* Limbs of the secp256k1 order. */
 #define SECP256K1_N_0 ((uint64_t)0xBFD25E8CD0364141ULL)
 #define SECP256K1_N_1 ((uint64_t)0xBAAEDCE6AF48A03BULL)
@@ -406,10 +409,372 @@ static void secp256k1_scalar_sqr_512(uint64_t l[8], const secp256k1_scalar_t *a)
 #undef extract
 #undef extract_fast
 
+#if defined(USE_ASM_X86_64)
+/* x86_64 assembly versions of secp256k1_scalar_mul_512 and secp256k1_scalar_reduce_512. They compute
+ * exactly the same column sums as the C versions above, keeping the 192-bit accumulator (c0,c1,c2) in
+ * three rotating registers instead of detecting carries with comparisons. */
+
+static void secp256k1_scalar_reduce_512_asm(secp256k1_scalar_t *r, const uint64_t *l) {
+    uint64_t c;
+
+    __asm__ __volatile__(
+    /* Reduce 512 bits into 385: m[0..6] = l[0..3] + n[0..3] * SECP256K1_N_C. */
+    "movq 0(%%rsi),%%rbx\n"
+    "xorq %%rcx,%%rcx\n"
+    "xorq %%r8,%%r8\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq 32(%%rsi)\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rdx,%%rcx\n"
+    "adcq $0,%%r8\n"
+    "xorq %%r9,%%r9\n"
+    "addq 8(%%rsi),%%rcx\n"
+    "adcq $0,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq 40(%%rsi)\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq 32(%%rsi)\n"
+    "addq %%rax,%%rcx\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "xorq %%r10,%%r10\n"
+    "addq 16(%%rsi),%%r8\n"
+    "adcq $0,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq 48(%%rsi)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq 40(%%rsi)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "addq 32(%%rsi),%%r8\n"
+    "adcq $0,%%r9\n"
+    "adcq $0,%%r10\n"
+    "xorq %%r11,%%r11\n"
+    "addq 24(%%rsi),%%r9\n"
+    "adcq $0,%%r10\n"
+    "adcq $0,%%r11\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq 56(%%rsi)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r11\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq 48(%%rsi)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r11\n"
+    "addq 40(%%rsi),%%r9\n"
+    "adcq $0,%%r10\n"
+    "adcq $0,%%r11\n"
+    "xorq %%r12,%%r12\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq 56(%%rsi)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r11\n"
+    "adcq $0,%%r12\n"
+    "addq 48(%%rsi),%%r10\n"
+    "adcq $0,%%r11\n"
+    "adcq $0,%%r12\n"
+    "xorq %%r13,%%r13\n"
+    "addq 56(%%rsi),%%r11\n"
+    "adcq $0,%%r12\n"
+    "adcq $0,%%r13\n"
+    /* Reduce 385 bits into 258: p[0..4] = m[0..3] + m[4..6] * SECP256K1_N_C. */
+    "xorq %%r13,%%r13\n"
+    "xorq %%r14,%%r14\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq %%r10\n"
+    "addq %%rax,%%rbx\n"
+    "adcq %%rdx,%%r13\n"
+    "adcq $0,%%r14\n"
+    "xorq %%r15,%%r15\n"
+    "addq %%rcx,%%r13\n"
+    "adcq $0,%%r14\n"
+    "adcq $0,%%r15\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq %%r11\n"
+    "addq %%rax,%%r13\n"
+    "adcq %%rdx,%%r14\n"
+    "adcq $0,%%r15\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq %%r10\n"
+    "addq %%rax,%%r13\n"
+    "adcq %%rdx,%%r14\n"
+    "adcq $0,%%r15\n"
+    "xorq %%rcx,%%rcx\n"
+    "addq %%r8,%%r14\n"
+    "adcq $0,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq %%r12\n"
+    "addq %%rax,%%r14\n"
+    "adcq %%rdx,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq %%r11\n"
+    "addq %%rax,%%r14\n"
+    "adcq %%rdx,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "addq %%r10,%%r14\n"
+    "adcq $0,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "xorq %%r10,%%r10\n"
+    "addq %%r9,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "adcq $0,%%r10\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq %%r12\n"
+    "addq %%rax,%%r15\n"
+    "adcq %%rdx,%%rcx\n"
+    "adcq $0,%%r10\n"
+    "addq %%r11,%%r15\n"
+    "adcq $0,%%rcx\n"
+    "adcq $0,%%r10\n"
+    "addq %%r12,%%rcx\n"
+    /* Reduce 258 bits into 256: r[0..3] = p[0..3] + p[4] * SECP256K1_N_C. */
+    "movq $0x402DA1732FC9BEBF,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%rbx,%%rax\n"
+    "adcq $0,%%rdx\n"
+    "movq %%rax,0(%%rdi)\n"
+    "movq %%rdx,%%rbx\n"
+    "movq $0x4551231950B75FC4,%%rax\n"
+    "mulq %%rcx\n"
+    "addq %%r13,%%rax\n"
+    "adcq $0,%%rdx\n"
+    "addq %%rbx,%%rax\n"
+    "adcq $0,%%rdx\n"
+    "movq %%rax,8(%%rdi)\n"
+    "movq %%rdx,%%rbx\n"
+    "xorq %%rdx,%%rdx\n"
+    "addq %%rcx,%%r14\n"
+    "adcq $0,%%rdx\n"
+    "addq %%rbx,%%r14\n"
+    "adcq $0,%%rdx\n"
+    "movq %%r14,16(%%rdi)\n"
+    "addq %%rdx,%%r15\n"
+    "movq $0,%%rdx\n"
+    "adcq $0,%%rdx\n"
+    "movq %%r15,24(%%rdi)\n"
+    : "=d"(c)
+    : "S"(l), "D"(r->d)
+    : "%rax", "%rbx", "%rcx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+    );
+
+    /* Final reduction of r. */
+    secp256k1_scalar_reduce(r, c + secp256k1_scalar_check_overflow(r));
+}
+
+#if defined(USE_CPU_DISPATCH)
+/* Row-wise schoolbook multiplication with MULX, which leaves the flags alone, and two independent carry
+ * chains: ADCX for the low halves of the products and ADOX for the high halves. */
+static void secp256k1_scalar_mul_512_bmi2(uint64_t l[8], const secp256k1_scalar_t *a, const secp256k1_scalar_t *b) {
+    __asm__ __volatile__(
+    /* Row 0: l[0..4] = a0 * b */
+    "xorl %%r15d,%%r15d\n"
+    "movq 0(%%rsi),%%rdx\n"
+    "mulx 0(%%rbx),%%r8,%%r9\n"
+    "mulx 8(%%rbx),%%rax,%%r10\n"
+    "adcx %%rax,%%r9\n"
+    "mulx 16(%%rbx),%%rax,%%r11\n"
+    "adcx %%rax,%%r10\n"
+    "mulx 24(%%rbx),%%rax,%%r12\n"
+    "adcx %%rax,%%r11\n"
+    "adcx %%r15,%%r12\n"
+    "movq %%r8,0(%%rdi)\n"
+    /* Row 1: l[1..5] += a1 * b (low half into adcx, high half into adox) */
+    "xorl %%eax,%%eax\n"
+    "movq 8(%%rsi),%%rdx\n"
+    "mulx 0(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r9\n"
+    "adox %%rcx,%%r10\n"
+    "mulx 8(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r10\n"
+    "adox %%rcx,%%r11\n"
+    "mulx 16(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r11\n"
+    "adox %%rcx,%%r12\n"
+    "mulx 24(%%rbx),%%rax,%%r13\n"
+    "adcx %%rax,%%r12\n"
+    "adox %%r15,%%r13\n"
+    "adcx %%r15,%%r13\n"
+    "movq %%r9,8(%%rdi)\n"
+    /* Row 2: l[2..6] += a2 * b (low half into adcx, high half into adox) */
+    "xorl %%eax,%%eax\n"
+    "movq 16(%%rsi),%%rdx\n"
+    "mulx 0(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r10\n"
+    "adox %%rcx,%%r11\n"
+    "mulx 8(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r11\n"
+    "adox %%rcx,%%r12\n"
+    "mulx 16(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r12\n"
+    "adox %%rcx,%%r13\n"
+    "mulx 24(%%rbx),%%rax,%%r14\n"
+    "adcx %%rax,%%r13\n"
+    "adox %%r15,%%r14\n"
+    "adcx %%r15,%%r14\n"
+    "movq %%r10,16(%%rdi)\n"
+    /* Row 3: l[3..7] += a3 * b (low half into adcx, high half into adox) */
+    "xorl %%eax,%%eax\n"
+    "movq 24(%%rsi),%%rdx\n"
+    "mulx 0(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r11\n"
+    "adox %%rcx,%%r12\n"
+    "mulx 8(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r12\n"
+    "adox %%rcx,%%r13\n"
+    "mulx 16(%%rbx),%%rax,%%rcx\n"
+    "adcx %%rax,%%r13\n"
+    "adox %%rcx,%%r14\n"
+    "mulx 24(%%rbx),%%rax,%%r8\n"
+    "adcx %%rax,%%r14\n"
+    "adox %%r15,%%r8\n"
+    "adcx %%r15,%%r8\n"
+    "movq %%r11,24(%%rdi)\n"
+    "movq %%r12,32(%%rdi)\n"
+    "movq %%r13,40(%%rdi)\n"
+    "movq %%r14,48(%%rdi)\n"
+    "movq %%r8,56(%%rdi)\n"
+    :
+    : "S"(a->d), "b"(b->d), "D"(l)
+    : "%rax", "%rcx", "%rdx", "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15", "cc", "memory"
+    );
+}
+#endif
+
+static void secp256k1_scalar_mul_512_asm(uint64_t l[8], const secp256k1_scalar_t *a, const secp256k1_scalar_t *b) {
+#if defined(USE_CPU_DISPATCH)
+    if (secp256k1_cpu_has(SECP256K1_CPU_BMI2)) {
+        secp256k1_scalar_mul_512_bmi2(l, a, b);
+        return;
+    }
+#endif
+    __asm__ __volatile__(
+    /* l[0]: a0*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "movq %%rax,0(%%rdi)\n"
+    "movq %%rdx,%%r9\n"
+    "xorq %%r10,%%r10\n"
+    "xorq %%r8,%%r8\n"
+    /* l[1]: a0*b1 + a1*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r8\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r8\n"
+    "movq %%r9,8(%%rdi)\n"
+    "xorq %%r9,%%r9\n"
+    /* l[2]: a0*b2 + a1*b1 + a2*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq %%r10,16(%%rdi)\n"
+    "xorq %%r10,%%r10\n"
+    /* l[3]: a0*b3 + a1*b2 + a2*b1 + a3*b0 */
+    "movq 0(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 0(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "adcq $0,%%r10\n"
+    "movq %%r8,24(%%rdi)\n"
+    "xorq %%r8,%%r8\n"
+    /* l[4]: a1*b3 + a2*b2 + a3*b1 */
+    "movq 8(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r8\n"
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r8\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 8(%%rbx)\n"
+    "addq %%rax,%%r9\n"
+    "adcq %%rdx,%%r10\n"
+    "adcq $0,%%r8\n"
+    "movq %%r9,32(%%rdi)\n"
+    "xorq %%r9,%%r9\n"
+    /* l[5]: a2*b3 + a3*b2 */
+    "movq 16(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 16(%%rbx)\n"
+    "addq %%rax,%%r10\n"
+    "adcq %%rdx,%%r8\n"
+    "adcq $0,%%r9\n"
+    "movq %%r10,40(%%rdi)\n"
+    /* l[6]: a3*b3 */
+    "movq 24(%%rsi),%%rax\n"
+    "mulq 24(%%rbx)\n"
+    "addq %%rax,%%r8\n"
+    "adcq %%rdx,%%r9\n"
+    "movq %%r8,48(%%rdi)\n"
+    "movq %%r9,56(%%rdi)\n"
+    :
+    : "S"(a->d), "b"(b->d), "D"(l)
+    : "%rax", "%rdx", "%r8", "%r9", "%r10", "cc", "memory"
+    );
+}
+#endif
+
 static void secp256k1_scalar_mul(secp256k1_scalar_t *r, const secp256k1_scalar_t *a, const secp256k1_scalar_t *b) {
     uint64_t l[8];
+#if defined(USE_ASM_X86_64)
+    secp256k1_scalar_mul_512_asm(l, a, b);
+    secp256k1_scalar_reduce_512_asm(r, l);
+#else
     secp256k1_scalar_mul_512(l, a, b);
     secp256k1_scalar_reduce_512(r, l);
+#endif
 }
 
 static int secp256k1_scalar_shr_int(secp256k1_scalar_t *r, int n) {
@@ -427,7 +792,11 @@ static int secp256k1_scalar_shr_int(secp256k1_scalar_t *r, int n) {
 static void secp256k1_scalar_sqr(secp256k1_scalar_t *r, const secp256k1_scalar_t *a) {
     uint64_t l[8];
     secp256k1_scalar_sqr_512(l, a);
+#if defined(USE_ASM_X86_64)
+    secp256k1_scalar_reduce_512_asm(r, l);
+#else
     secp256k1_scalar_reduce_512(r, l);
+#endif
 }
 
 static void secp256k1_scalar_split_128(secp256k1_scalar_t *r1, secp256k1_scalar_t *r2, const secp256k1_scalar_t *a) {
@@ -451,7 +820,11 @@ SECP256K1_INLINE static void secp256k1_scalar_mul_shift_var(secp256k1_scalar_t *
     unsigned int shiftlow;
     unsigned int shifthigh;
     VERIFY_CHECK(shift >= 256);
+#if defined(USE_ASM_X86_64)
+    secp256k1_scalar_mul_512_asm(l, a, b);
+#else
     secp256k1_scalar_mul_512(l, a, b);
+#endif
     shiftlimbs = shift >> 6;
     shiftlow = shift & 0x3F;
     shifthigh = 64 - shiftlow;
@@ -464,4 +837,74 @@ SECP256K1_INLINE static void secp256k1_scalar_mul_shift_var(secp256k1_scalar_t *
     }
 }
 
+static void secp256k1_scalar_from_signed62(secp256k1_scalar_t *r, const secp256k1_modinv64_signed62_t *a) {
+    const uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2], a3 = a->v[3], a4 = a->v[4];
+
+    /* The output from secp256k1_modinv64{_var} is normalized to range [0,modulus), and has limbs
+     * in [0,2^62). The modulus is < 2^256, so the top limb must be below 2^(256-62*4). */
+    VERIFY_CHECK(a0 >> 62 == 0);
+    VERIFY_CHECK(a1 >> 62 == 0);
+    VERIFY_CHECK(a2 >> 62 == 0);
+    VERIFY_CHECK(a3 >> 62 == 0);
+    VERIFY_CHECK(a4 >> 8 == 0);
+
+    r->d[0] = a0      | a1 << 62;
+    r->d[1] = a1 >> 2 | a2 << 60;
+    r->d[2] = a2 >> 4 | a3 << 58;
+    r->d[3] = a3 >> 6 | a4 << 56;
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(r) == 0);
+#endif
+}
+
+static void secp256k1_scalar_to_signed62(secp256k1_modinv64_signed62_t *r, const secp256k1_scalar_t *a) {
+    const uint64_t M62 = UINT64_MAX >> 2;
+    const uint64_t a0 = a->d[0], a1 = a->d[1], a2 = a->d[2], a3 = a->d[3];
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_check_overflow(a) == 0);
+#endif
+
+    r->v[0] =  a0                   & M62;
+    r->v[1] = (a0 >> 62 | a1 <<  2) & M62;
+    r->v[2] = (a1 >> 60 | a2 <<  4) & M62;
+    r->v[3] = (a2 >> 58 | a3 <<  6) & M62;
+    r->v[4] =  a3 >> 56;
+}
+
+/* The group order n in signed62 notation, and n^-1 mod 2^62. */
+static const secp256k1_modinv64_modinfo_t secp256k1_const_modinfo_scalar = {
+    {{0x3FD25E8CD0364141LL, 0x2ABB739ABD2280EELL, -0x15LL, 0, 256}},
+    0x34F20099AA774EC1LL
+};
+
+static void secp256k1_scalar_inverse(secp256k1_scalar_t *r, const secp256k1_scalar_t *x) {
+    secp256k1_modinv64_signed62_t s;
+#ifdef VERIFY
+    int zero_in = secp256k1_scalar_is_zero(x);
+#endif
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_is_zero(r) == zero_in);
+#endif
+}
+
+static void secp256k1_scalar_inverse_var(secp256k1_scalar_t *r, const secp256k1_scalar_t *x) {
+    secp256k1_modinv64_signed62_t s;
+#ifdef VERIFY
+    int zero_in = secp256k1_scalar_is_zero(x);
+#endif
+    secp256k1_scalar_to_signed62(&s, x);
+    secp256k1_modinv64_var(&s, &secp256k1_const_modinfo_scalar);
+    secp256k1_scalar_from_signed62(r, &s);
+
+#ifdef VERIFY
+    VERIFY_CHECK(secp256k1_scalar_is_zero(r) == zero_in);
+#endif
+}
+
 #endif
@@ -0,0 +1,36 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_SCRATCH_
+#define _SECP256K1_SCRATCH_
+
+#include "util.h"
+
+/** A bump allocator over one block of memory, for the large temporaries of functions that must not
+ *  need a big stack. Allocations are only released by returning to an earlier checkpoint, so functions
+ *  drawing from a scratch space leave it as is; whoever took the checkpoint resets it. */
+struct secp256k1_scratch_space_struct {
+    unsigned char *data;
+    size_t alloc_size; /* bytes handed out so far */
+    size_t max_size;
+};
+
+/** Use size bytes at data, which must be aligned for any of the library's types, as the arena. */
+static void secp256k1_scratch_init(secp256k1_scratch_space_t *scratch, void *data, size_t size);
+
+static size_t secp256k1_scratch_checkpoint(const secp256k1_scratch_space_t *scratch);
+
+/** Release everything allocated since checkpoint was taken. */
+static void secp256k1_scratch_apply_checkpoint(secp256k1_scratch_space_t *scratch, size_t checkpoint);
+
+/** Zero everything allocated since checkpoint was taken, then release it. For allocations that held secrets. */
+static void secp256k1_scratch_clear_to_checkpoint(secp256k1_scratch_space_t *scratch, size_t checkpoint);
+
+/** Returns size bytes (a whole number of cache lines apart from other allocations), or NULL if the
+ *  arena is exhausted. */
+static void *secp256k1_scratch_alloc(secp256k1_scratch_space_t *scratch, size_t size);
+
+#endif
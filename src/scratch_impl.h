@@ -0,0 +1,44 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_SCRATCH_IMPL_H_
+#define _SECP256K1_SCRATCH_IMPL_H_
+
+#include "scratch.h"
+
+static void secp256k1_scratch_init(secp256k1_scratch_space_t *scratch, void *data, size_t size) {
+    scratch->data = (unsigned char *)data;
+    scratch->alloc_size = 0;
+    scratch->max_size = size;
+}
+
+static size_t secp256k1_scratch_checkpoint(const secp256k1_scratch_space_t *scratch) {
+    return scratch->alloc_size;
+}
+
+static void secp256k1_scratch_apply_checkpoint(secp256k1_scratch_space_t *scratch, size_t checkpoint) {
+    VERIFY_CHECK(checkpoint <= scratch->alloc_size);
+    scratch->alloc_size = checkpoint;
+}
+
+static void secp256k1_scratch_clear_to_checkpoint(secp256k1_scratch_space_t *scratch, size_t checkpoint) {
+    VERIFY_CHECK(checkpoint <= scratch->alloc_size);
+    memset(scratch->data + checkpoint, 0, scratch->alloc_size - checkpoint);
+    scratch->alloc_size = checkpoint;
+}
+
+static void *secp256k1_scratch_alloc(secp256k1_scratch_space_t *scratch, size_t size) {
+    void *ret;
+    size = ROUND_TO_ALIGN(size);
+    if (size > scratch->max_size - scratch->alloc_size) {
+        return NULL;
+    }
+    ret = scratch->data + scratch->alloc_size;
+    scratch->alloc_size += size;
+    return ret;
+}
+
+#endif
@@ -8,11 +8,26 @@
 
 #include "include/secp256k1.h"
 
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#ifdef HAVE_SYS_EVENTFD_H
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
 #include "util.h"
+#include "cpu_impl.h"
+#include "tables_impl.h"
+#include "scratch_impl.h"
+#include "parallel_impl.h"
 #include "num_impl.h"
 #include "field_impl.h"
 #include "scalar_impl.h"
 #include "group_impl.h"
+#include "group_4way_impl.h"
 #include "ecdsa_impl.h"
 #include "ecdh_impl.h"
 #include "ecmult_impl.h"
@@ -28,48 +43,147 @@ struct secp256k1_context_struct {
     secp256k1_ecmult_gen_context_t ecmult_gen_ctx;
     secp256k1_ecmult_gen2_context_t ecmult_gen2_ctx;
     secp256k1_rangeproof_context_t rangeproof_ctx;
+    secp256k1_tables_t tables; /* backs all of the above tables; the ecmult ones come first */
+    int hugepages;
 };
 
-secp256k1_context_t* secp256k1_context_create(int flags) {
-    secp256k1_context_t* ret = (secp256k1_context_t*)checked_malloc(sizeof(secp256k1_context_t));
-
-    secp256k1_ecmult_context_init(&ret->ecmult_ctx);
-    secp256k1_ecmult_gen_context_init(&ret->ecmult_gen_ctx);
-    secp256k1_ecmult_gen2_context_init(&ret->ecmult_gen2_ctx);
-    secp256k1_rangeproof_context_init(&ret->rangeproof_ctx);
-
+static size_t secp256k1_context_tables_size(int flags) {
+    size_t ret = 0;
+    if (flags & SECP256K1_CONTEXT_VERIFY) {
+        ret += SECP256K1_ECMULT_CONTEXT_TABLE_SIZE;
+    }
     if (flags & SECP256K1_CONTEXT_SIGN) {
-        secp256k1_ecmult_gen_context_build(&ret->ecmult_gen_ctx);
+        ret += SECP256K1_ECMULT_GEN_CONTEXT_TABLE_SIZE;
+    }
+    if (flags & SECP256K1_CONTEXT_COMMIT) {
+        ret += SECP256K1_ECMULT_GEN2_CONTEXT_TABLE_SIZE;
+    }
+    if (flags & SECP256K1_CONTEXT_RANGEPROOF) {
+        ret += SECP256K1_RANGEPROOF_CONTEXT_TABLE_SIZE;
     }
+    return ret;
+}
+
+/* Build the tables flags asks for in ctx->tables, which holds secp256k1_context_tables_size(flags) bytes. */
+static void secp256k1_context_build(secp256k1_context_t* ctx, int flags) {
+    void *prealloc = ctx->tables.data;
+
+    secp256k1_cpu_init();
+    secp256k1_ecmult_context_init(&ctx->ecmult_ctx);
+    secp256k1_ecmult_gen_context_init(&ctx->ecmult_gen_ctx);
+    secp256k1_ecmult_gen2_context_init(&ctx->ecmult_gen2_ctx);
+    secp256k1_rangeproof_context_init(&ctx->rangeproof_ctx);
+
     if (flags & SECP256K1_CONTEXT_VERIFY) {
-        secp256k1_ecmult_context_build(&ret->ecmult_ctx);
+        secp256k1_ecmult_context_build(&ctx->ecmult_ctx, &prealloc);
+    }
+    if (flags & SECP256K1_CONTEXT_SIGN) {
+        secp256k1_ecmult_gen_context_build(&ctx->ecmult_gen_ctx, &prealloc);
     }
     if (flags & SECP256K1_CONTEXT_COMMIT) {
-        secp256k1_ecmult_gen2_context_build(&ret->ecmult_gen2_ctx);
+        secp256k1_ecmult_gen2_context_build(&ctx->ecmult_gen2_ctx, &prealloc);
     }
     if (flags & SECP256K1_CONTEXT_RANGEPROOF) {
-        secp256k1_rangeproof_context_build(&ret->rangeproof_ctx);
+        secp256k1_rangeproof_context_build(&ctx->rangeproof_ctx, &prealloc);
     }
+    VERIFY_CHECK((size_t)((unsigned char *)prealloc - (unsigned char *)ctx->tables.data) == ctx->tables.size);
+}
+
+/* Copy the tables of src into dst->tables, which holds src->tables.size bytes. */
+static void secp256k1_context_copy(secp256k1_context_t* dst, const secp256k1_context_t* src) {
+    void *prealloc = dst->tables.data;
+    secp256k1_ecmult_context_clone(&dst->ecmult_ctx, &src->ecmult_ctx, &prealloc);
+    secp256k1_ecmult_gen_context_clone(&dst->ecmult_gen_ctx, &src->ecmult_gen_ctx, &prealloc);
+    secp256k1_ecmult_gen2_context_clone(&dst->ecmult_gen2_ctx, &src->ecmult_gen2_ctx, &prealloc);
+    secp256k1_rangeproof_context_clone(&dst->rangeproof_ctx, &src->rangeproof_ctx, &prealloc);
+}
 
+secp256k1_context_t* secp256k1_context_create(int flags) {
+    secp256k1_context_t* ret = (secp256k1_context_t*)checked_malloc(sizeof(secp256k1_context_t));
+    ret->hugepages = (flags & SECP256K1_CONTEXT_HUGEPAGES) != 0;
+    secp256k1_tables_alloc(&ret->tables, secp256k1_context_tables_size(flags), ret->hugepages);
+    secp256k1_context_build(ret, flags);
     return ret;
 }
 
 secp256k1_context_t* secp256k1_context_clone(const secp256k1_context_t* ctx) {
     secp256k1_context_t* ret = (secp256k1_context_t*)checked_malloc(sizeof(secp256k1_context_t));
-    secp256k1_ecmult_context_clone(&ret->ecmult_ctx, &ctx->ecmult_ctx);
-    secp256k1_ecmult_gen_context_clone(&ret->ecmult_gen_ctx, &ctx->ecmult_gen_ctx);
-    secp256k1_ecmult_gen2_context_clone(&ret->ecmult_gen2_ctx, &ctx->ecmult_gen2_ctx);
-    secp256k1_rangeproof_context_clone(&ret->rangeproof_ctx, &ctx->rangeproof_ctx);
+    ret->hugepages = ctx->hugepages;
+    secp256k1_tables_alloc(&ret->tables, ctx->tables.size, ret->hugepages);
+    secp256k1_context_copy(ret, ctx);
     return ret;
 }
 
 void secp256k1_context_destroy(secp256k1_context_t* ctx) {
+    secp256k1_context_preallocated_destroy(ctx);
+    free(ctx);
+}
+
+/* A preallocated context puts its tables at the start of the caller's memory, so a 2 MiB-aligned buffer
+ * keeps the G tables aligned too, and the context object itself right after them. */
+size_t secp256k1_context_preallocated_size(int flags) {
+    return secp256k1_context_tables_size(flags) + sizeof(secp256k1_context_t);
+}
+
+secp256k1_context_t* secp256k1_context_preallocated_create(void* prealloc, int flags) {
+    size_t size = secp256k1_context_tables_size(flags);
+    secp256k1_context_t* ret;
+    DEBUG_CHECK(prealloc != NULL);
+    ret = (secp256k1_context_t*)((unsigned char *)prealloc + size);
+    ret->hugepages = 0;
+    secp256k1_tables_set(&ret->tables, prealloc, size);
+    secp256k1_context_build(ret, flags);
+    return ret;
+}
+
+size_t secp256k1_context_preallocated_clone_size(const secp256k1_context_t* ctx) {
+    DEBUG_CHECK(ctx != NULL);
+    return ctx->tables.size + sizeof(secp256k1_context_t);
+}
+
+secp256k1_context_t* secp256k1_context_preallocated_clone(const secp256k1_context_t* ctx, void* prealloc) {
+    secp256k1_context_t* ret;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(prealloc != NULL);
+    ret = (secp256k1_context_t*)((unsigned char *)prealloc + ctx->tables.size);
+    ret->hugepages = 0;
+    secp256k1_tables_set(&ret->tables, prealloc, ctx->tables.size);
+    secp256k1_context_copy(ret, ctx);
+    return ret;
+}
+
+void secp256k1_context_preallocated_destroy(secp256k1_context_t* ctx) {
     secp256k1_ecmult_context_clear(&ctx->ecmult_ctx);
     secp256k1_ecmult_gen_context_clear(&ctx->ecmult_gen_ctx);
     secp256k1_ecmult_gen2_context_clear(&ctx->ecmult_gen2_ctx);
     secp256k1_rangeproof_context_clear(&ctx->rangeproof_ctx);
+    secp256k1_tables_free(&ctx->tables);
+}
 
-    free(ctx);
+secp256k1_scratch_space_t* secp256k1_scratch_space_create(size_t size) {
+    secp256k1_scratch_space_t* ret = (secp256k1_scratch_space_t*)checked_malloc(ROUND_TO_ALIGN(sizeof(secp256k1_scratch_space_t)) + size);
+    secp256k1_scratch_init(ret, (unsigned char *)ret + ROUND_TO_ALIGN(sizeof(secp256k1_scratch_space_t)), size);
+    return ret;
+}
+
+void secp256k1_scratch_space_destroy(secp256k1_scratch_space_t* scratch) {
+    free(scratch);
+}
+
+size_t secp256k1_scratch_space_checkpoint(const secp256k1_scratch_space_t* scratch) {
+    DEBUG_CHECK(scratch != NULL);
+    return secp256k1_scratch_checkpoint(scratch);
+}
+
+void secp256k1_scratch_space_reset(secp256k1_scratch_space_t* scratch, size_t checkpoint) {
+    DEBUG_CHECK(scratch != NULL);
+    DEBUG_CHECK(checkpoint <= secp256k1_scratch_checkpoint(scratch));
+    secp256k1_scratch_apply_checkpoint(scratch, checkpoint);
+}
+
+int secp256k1_context_tables_mode(const secp256k1_context_t* ctx) {
+    DEBUG_CHECK(ctx != NULL);
+    return ctx->tables.mode;
 }
 
 int secp256k1_ecdsa_verify(const secp256k1_context_t* ctx, const unsigned char *msg32, const unsigned char *sig, int siglen, const unsigned char *pubkey, int pubkeylen) {
@@ -165,6 +279,278 @@ int secp256k1_ecdsa_sign(const secp256k1_context_t* ctx, const unsigned char *ms
     return ret;
 }
 
+/* Draw nonces for counter values from *count on, until one is a valid scalar. Returns 0 if the nonce
+ * function fails first. */
+static int secp256k1_ecdsa_sign_nonce(secp256k1_scalar_t *non, secp256k1_nonce_function_t noncefp, const unsigned char *msg32, const unsigned char *seckey, unsigned int *count, const void* noncedata) {
+    unsigned char nonce32[32];
+    int overflow = 0;
+    while (1) {
+        if (!noncefp(nonce32, msg32, seckey, *count, noncedata)) {
+            return 0;
+        }
+        secp256k1_scalar_set_b32(non, nonce32, &overflow);
+        memset(nonce32, 0, 32);
+        if (!secp256k1_scalar_is_zero(non) && !overflow) {
+            return 1;
+        }
+        (*count)++;
+    }
+}
+
+int secp256k1_ecdsa_sign_batch(const secp256k1_context_t* ctx, const unsigned char * const *msg32, unsigned char * const *signature, int *signaturelen, const unsigned char * const *seckey, size_t n, secp256k1_nonce_function_t noncefp, const void* noncedata) {
+    secp256k1_ecdsa_sig_t sig[SECP256K1_ECDSA_SIGN_BATCH];
+    secp256k1_scalar_t sec[SECP256K1_ECDSA_SIGN_BATCH], msg[SECP256K1_ECDSA_SIGN_BATCH], non[SECP256K1_ECDSA_SIGN_BATCH];
+    unsigned int count[SECP256K1_ECDSA_SIGN_BATCH];
+    size_t idx[SECP256K1_ECDSA_SIGN_BATCH];
+    int ok[SECP256K1_ECDSA_SIGN_BATCH];
+    size_t next = 0, k = 0, i, j;
+    int ret = 1;
+    int overflow = 0;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(msg32 != NULL || n == 0);
+    DEBUG_CHECK(signature != NULL || n == 0);
+    DEBUG_CHECK(signaturelen != NULL || n == 0);
+    DEBUG_CHECK(seckey != NULL || n == 0);
+    if (noncefp == NULL) {
+        noncefp = secp256k1_nonce_function_default;
+    }
+
+    /* Sign up to SECP256K1_ECDSA_SIGN_BATCH items per round. An item whose nonce gives no signature
+     * stays for the next round with the next counter value, exactly as secp256k1_ecdsa_sign would
+     * retry it, and new items fill the remaining slots. */
+    while (next < n || k > 0) {
+        for (; k < SECP256K1_ECDSA_SIGN_BATCH && next < n; next++) {
+            secp256k1_scalar_set_b32(&sec[k], seckey[next], &overflow);
+            /* Fail if the secret key is invalid. */
+            if (overflow || secp256k1_scalar_is_zero(&sec[k])) {
+                signaturelen[next] = 0;
+                ret = 0;
+                continue;
+            }
+            secp256k1_scalar_set_b32(&msg[k], msg32[next], NULL);
+            idx[k] = next;
+            count[k] = 0;
+            k++;
+        }
+
+        /* Draw a nonce for every item, dropping those whose nonce function fails. */
+        for (i = j = 0; i < k; i++) {
+            sec[j] = sec[i];
+            msg[j] = msg[i];
+            idx[j] = idx[i];
+            count[j] = count[i];
+            if (secp256k1_ecdsa_sign_nonce(&non[j], noncefp, msg32[idx[j]], seckey[idx[j]], &count[j], noncedata)) {
+                j++;
+            } else {
+                signaturelen[idx[j]] = 0;
+                ret = 0;
+            }
+        }
+
+        secp256k1_ecdsa_sig_sign_batch(&ctx->ecmult_gen_ctx, ok, j, sig, sec, msg, non, NULL);
+
+        for (i = k = 0; i < j; i++) {
+            if (ok[i]) {
+                if (!secp256k1_ecdsa_sig_serialize(signature[idx[i]], &signaturelen[idx[i]], &sig[i])) {
+                    signaturelen[idx[i]] = 0;
+                    ret = 0;
+                }
+            } else {
+                sec[k] = sec[i];
+                msg[k] = msg[i];
+                idx[k] = idx[i];
+                count[k] = count[i] + 1;
+                k++;
+            }
+        }
+    }
+
+    for (i = 0; i < SECP256K1_ECDSA_SIGN_BATCH; i++) {
+        secp256k1_scalar_clear(&sec[i]);
+        secp256k1_scalar_clear(&msg[i]);
+        secp256k1_scalar_clear(&non[i]);
+    }
+    return ret;
+}
+
+typedef struct {
+    secp256k1_scalar_t r;
+    secp256k1_scalar_t ni; /* the inverse of the nonce that gave r */
+} secp256k1_presig_t;
+
+struct secp256k1_presig_pool_struct {
+    secp256k1_presig_t *ring;
+    size_t capacity;
+    size_t start;
+    size_t count;
+    secp256k1_rfc6979_hmac_sha256_t rng; /* the nonces */
+#ifdef USE_PTHREADS
+    pthread_mutex_t lock; /* guards everything but capacity */
+#endif
+};
+
+/* Keeps the pool's nonces apart from any a nonce function derives from the same bytes. */
+static const unsigned char secp256k1_presig_pool_tag[] = "secp256k1 presignature pool";
+
+#ifdef USE_PTHREADS
+# define SECP256K1_PRESIG_POOL_LOCK(p) CHECK(pthread_mutex_lock(&(p)->lock) == 0)
+# define SECP256K1_PRESIG_POOL_UNLOCK(p) CHECK(pthread_mutex_unlock(&(p)->lock) == 0)
+#else
+# define SECP256K1_PRESIG_POOL_LOCK(p) ((void)(p))
+# define SECP256K1_PRESIG_POOL_UNLOCK(p) ((void)(p))
+#endif
+
+secp256k1_presig_pool_t* secp256k1_presig_pool_create(size_t capacity, const unsigned char *seed32) {
+    secp256k1_presig_pool_t *pool;
+    DEBUG_CHECK(capacity > 0);
+    DEBUG_CHECK(seed32 != NULL);
+    pool = (secp256k1_presig_pool_t *)checked_malloc(sizeof(secp256k1_presig_pool_t));
+    pool->ring = (secp256k1_presig_t *)checked_malloc(sizeof(secp256k1_presig_t) * capacity);
+    pool->capacity = capacity;
+    pool->start = 0;
+    pool->count = 0;
+    secp256k1_rfc6979_hmac_sha256_initialize(&pool->rng, seed32, 32, secp256k1_presig_pool_tag, sizeof(secp256k1_presig_pool_tag), NULL, 0);
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_init(&pool->lock, NULL) == 0);
+#endif
+    return pool;
+}
+
+void secp256k1_presig_pool_destroy(secp256k1_presig_pool_t* pool) {
+    DEBUG_CHECK(pool != NULL);
+#ifdef USE_PTHREADS
+    pthread_mutex_destroy(&pool->lock);
+#endif
+    memset(pool->ring, 0, sizeof(secp256k1_presig_t) * pool->capacity);
+    secp256k1_rfc6979_hmac_sha256_finalize(&pool->rng);
+    free(pool->ring);
+    free(pool);
+}
+
+size_t secp256k1_presig_pool_refill(const secp256k1_context_t* ctx, secp256k1_presig_pool_t* pool, const unsigned char *seed32) {
+    secp256k1_ecdsa_sig_t sig[SECP256K1_ECDSA_SIGN_BATCH];
+    secp256k1_scalar_t non[SECP256K1_ECDSA_SIGN_BATCH], ni[SECP256K1_ECDSA_SIGN_BATCH];
+    int ok[SECP256K1_ECDSA_SIGN_BATCH];
+    unsigned char buf[32];
+    size_t added = 0, n, i;
+    int overflow = 0;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(pool != NULL);
+
+    SECP256K1_PRESIG_POOL_LOCK(pool);
+    if (seed32 != NULL) {
+        /* Rekey with the old state's output, so the new randomness adds to what was there. */
+        secp256k1_rfc6979_hmac_sha256_generate(&pool->rng, buf, 32);
+        secp256k1_rfc6979_hmac_sha256_initialize(&pool->rng, buf, 32, secp256k1_presig_pool_tag, sizeof(secp256k1_presig_pool_tag), seed32, 32);
+    }
+    SECP256K1_PRESIG_POOL_UNLOCK(pool);
+
+    /* Draw the nonces under the lock, but do the point multiplications without it, so signing can
+     * go on meanwhile. Entries that no longer fit by then are dropped. */
+    for (;;) {
+        SECP256K1_PRESIG_POOL_LOCK(pool);
+        n = pool->capacity - pool->count;
+        if (n > SECP256K1_ECDSA_SIGN_BATCH) {
+            n = SECP256K1_ECDSA_SIGN_BATCH;
+        }
+        for (i = 0; i < n; i++) {
+            do {
+                secp256k1_rfc6979_hmac_sha256_generate(&pool->rng, buf, 32);
+                secp256k1_scalar_set_b32(&non[i], buf, &overflow);
+            } while (overflow || secp256k1_scalar_is_zero(&non[i]));
+        }
+        SECP256K1_PRESIG_POOL_UNLOCK(pool);
+        if (n == 0) {
+            break;
+        }
+
+        secp256k1_ecdsa_sig_presign_batch(&ctx->ecmult_gen_ctx, ok, n, sig, ni, non, NULL);
+
+        SECP256K1_PRESIG_POOL_LOCK(pool);
+        for (i = 0; i < n && pool->count < pool->capacity; i++) {
+            if (ok[i]) {
+                secp256k1_presig_t *presig = &pool->ring[(pool->start + pool->count) % pool->capacity];
+                presig->r = sig[i].r;
+                presig->ni = ni[i];
+                pool->count++;
+                added++;
+            }
+        }
+        SECP256K1_PRESIG_POOL_UNLOCK(pool);
+    }
+
+    memset(buf, 0, 32);
+    for (i = 0; i < SECP256K1_ECDSA_SIGN_BATCH; i++) {
+        secp256k1_scalar_clear(&non[i]);
+        secp256k1_scalar_clear(&ni[i]);
+    }
+    return added;
+}
+
+size_t secp256k1_presig_pool_size(secp256k1_presig_pool_t* pool) {
+    size_t count;
+    DEBUG_CHECK(pool != NULL);
+    SECP256K1_PRESIG_POOL_LOCK(pool);
+    count = pool->count;
+    SECP256K1_PRESIG_POOL_UNLOCK(pool);
+    return count;
+}
+
+/* Move the oldest entry out of the pool, clearing its slot. Returns 0 if the pool is empty. */
+static int secp256k1_presig_pool_take(secp256k1_presig_pool_t* pool, secp256k1_presig_t *presig) {
+    int ret = 0;
+    SECP256K1_PRESIG_POOL_LOCK(pool);
+    if (pool->count > 0) {
+        *presig = pool->ring[pool->start];
+        memset(&pool->ring[pool->start], 0, sizeof(secp256k1_presig_t));
+        pool->start = (pool->start + 1) % pool->capacity;
+        pool->count--;
+        ret = 1;
+    }
+    SECP256K1_PRESIG_POOL_UNLOCK(pool);
+    return ret;
+}
+
+int secp256k1_ecdsa_sign_with_pool(const secp256k1_context_t* ctx, secp256k1_presig_pool_t* pool, const unsigned char *msg32, unsigned char *signature, int *signaturelen, const unsigned char *seckey) {
+    secp256k1_presig_t presig;
+    secp256k1_ecdsa_sig_t sig;
+    secp256k1_scalar_t sec, msg;
+    int ret = 0;
+    int overflow = 0;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(pool != NULL);
+    DEBUG_CHECK(msg32 != NULL);
+    DEBUG_CHECK(signature != NULL);
+    DEBUG_CHECK(signaturelen != NULL);
+    DEBUG_CHECK(seckey != NULL);
+
+    secp256k1_scalar_set_b32(&sec, seckey, &overflow);
+    /* Fail if the secret key is invalid. */
+    if (!overflow && !secp256k1_scalar_is_zero(&sec)) {
+        secp256k1_scalar_set_b32(&msg, msg32, NULL);
+        /* An entry that gives s = 0 is spent all the same, so go on to the next. */
+        while (secp256k1_presig_pool_take(pool, &presig)) {
+            sig.r = presig.r;
+            ret = secp256k1_ecdsa_sig_set_s(&sig, &sec, &msg, &presig.ni, NULL);
+            secp256k1_scalar_clear(&presig.ni);
+            if (ret) {
+                break;
+            }
+        }
+        if (ret) {
+            ret = secp256k1_ecdsa_sig_serialize(signature, signaturelen, &sig);
+        }
+        secp256k1_scalar_clear(&msg);
+        secp256k1_scalar_clear(&sec);
+    }
+    if (!ret) {
+        *signaturelen = 0;
+    }
+    return ret;
+}
+
 int secp256k1_ecdsa_sign_compact(const secp256k1_context_t* ctx, const unsigned char *msg32, unsigned char *sig64, const unsigned char *seckey, secp256k1_nonce_function_t noncefp, const void* noncedata, int *recid) {
     secp256k1_ecdsa_sig_t sig;
     secp256k1_scalar_t sec, non, msg;
@@ -568,10 +954,29 @@ int secp256k1_rangeproof_info(const secp256k1_context_t* ctx, int *exp, int *man
     return secp256k1_rangeproof_getheader_impl(&offset, exp, mantissa, &scale, min_value, max_value, proof, plen);
 }
 
+int secp256k1_rangeproof_verify_cost(const secp256k1_context_t* ctx, int *rings, int *npub, int *ecmults, int *explen,
+ const unsigned char *proof, int plen) {
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(rings != NULL);
+    DEBUG_CHECK(npub != NULL);
+    DEBUG_CHECK(ecmults != NULL);
+    DEBUG_CHECK(explen != NULL);
+    DEBUG_CHECK(proof != NULL);
+    (void)ctx;
+    if (!secp256k1_rangeproof_cost_impl(rings, npub, explen, proof, plen)) {
+        return 0;
+    }
+    /* The Borromean verifier does one ecmult per public key. */
+    *ecmults = *npub;
+    return plen == *explen;
+}
+
 int secp256k1_rangeproof_rewind(const secp256k1_context_t* ctx,
  unsigned char *blind_out, uint64_t *value_out, unsigned char *message_out, int *outlen, const unsigned char *nonce,
  uint64_t *min_value, uint64_t *max_value,
  const unsigned char *commit, const unsigned char *proof, int plen) {
+    uint64_t mem[(SECP256K1_RANGEPROOF_SCRATCH_SIZE + 7) / 8];
+    secp256k1_scratch_space_t scratch;
     DEBUG_CHECK(ctx != NULL);
     DEBUG_CHECK(commit != NULL);
     DEBUG_CHECK(proof != NULL);
@@ -581,12 +986,163 @@ int secp256k1_rangeproof_rewind(const secp256k1_context_t* ctx,
     DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
     DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
     DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
-    return secp256k1_rangeproof_verify_impl(&ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+    secp256k1_scratch_init(&scratch, mem, sizeof(mem));
+    return secp256k1_rangeproof_verify_impl(&scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
      blind_out, value_out, message_out, outlen, nonce, min_value, max_value, commit, proof, plen);
 }
 
+int secp256k1_rangeproof_rewind_check(const secp256k1_context_t* ctx, const unsigned char *nonce,
+ const unsigned char *commit, const unsigned char *proof, int plen) {
+    uint64_t mem[(SECP256K1_RANGEPROOF_SCRATCH_SIZE + 7) / 8];
+    secp256k1_scratch_space_t scratch;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(nonce != NULL);
+    DEBUG_CHECK(commit != NULL);
+    DEBUG_CHECK(proof != NULL);
+    (void)ctx;
+    secp256k1_scratch_init(&scratch, mem, sizeof(mem));
+    return secp256k1_rangeproof_rewind_check_impl(&scratch, nonce, commit, proof, plen);
+}
+
+typedef struct {
+    const secp256k1_context_t *ctx;
+    int *nonce_idx;
+    unsigned char *blinds_out;
+    uint64_t *values_out;
+    unsigned char *messages_out;
+    int *mlens;
+    const unsigned char * const *nonces;
+    int nnonces;
+    const unsigned char * const *commits;
+    const unsigned char * const *proofs;
+    const int *plens;
+    secp256k1_scratch_space_t *scratch; /* one per worker */
+} secp256k1_rewind_scan_t;
+
+static void secp256k1_rewind_scan_process(void *data, int worker, size_t begin, size_t end) {
+    const secp256k1_rewind_scan_t *scan = (const secp256k1_rewind_scan_t *)data;
+    const secp256k1_context_t *ctx = scan->ctx;
+    secp256k1_scratch_space_t *scratch = &scan->scratch[worker];
+    unsigned char blind[32];
+    uint64_t value;
+    unsigned char message[4096];
+    int mlen;
+    size_t i;
+    int j;
+    for (i = begin; i < end; i++) {
+        scan->nonce_idx[i] = -1;
+        for (j = 0; j < scan->nnonces; j++) {
+            uint64_t min_value;
+            uint64_t max_value;
+            int ret;
+            ret = secp256k1_rangeproof_rewind_check_impl(scratch, scan->nonces[j], scan->commits[i], scan->proofs[i], scan->plens[i]);
+            secp256k1_scratch_clear_to_checkpoint(scratch, 0);
+            if (!ret) {
+                continue;
+            }
+            /* Rewind into locals: the outputs are filled before the proof is known to be valid. */
+            mlen = 4096;
+            ret = secp256k1_rangeproof_verify_impl(scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+             blind, &value, scan->messages_out ? message : NULL, scan->messages_out ? &mlen : NULL, scan->nonces[j],
+             &min_value, &max_value, scan->commits[i], scan->proofs[i], scan->plens[i]);
+            secp256k1_scratch_clear_to_checkpoint(scratch, 0);
+            if (ret) {
+                if (scan->blinds_out) {
+                    memcpy(&scan->blinds_out[i * 32], blind, 32);
+                }
+                if (scan->values_out) {
+                    scan->values_out[i] = value;
+                }
+                if (scan->messages_out) {
+                    memcpy(&scan->messages_out[i * 4096], message, 4096);
+                    scan->mlens[i] = mlen;
+                }
+                scan->nonce_idx[i] = j;
+                break;
+            }
+        }
+    }
+    memset(blind, 0, 32);
+    memset(message, 0, 4096);
+}
+
+int secp256k1_rangeproof_rewind_scan(const secp256k1_context_t* ctx, int *nonce_idx, unsigned char *blinds_out,
+ uint64_t *values_out, unsigned char *messages_out, int *mlens, const unsigned char * const *nonces, int nnonces,
+ const unsigned char * const *commits, const unsigned char * const *proofs, const int *plens, int n,
+ int nthreads, secp256k1_executor_function_t executor, void *data) {
+    secp256k1_rewind_scan_t scan;
+    secp256k1_parallel_t par;
+    unsigned char *mem;
+    size_t size;
+    int nworkers = nthreads;
+    int found;
+    int w;
+    int i;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(nonce_idx != NULL);
+    DEBUG_CHECK(!nnonces || (nonces != NULL));
+    DEBUG_CHECK(commits != NULL);
+    DEBUG_CHECK(proofs != NULL);
+    DEBUG_CHECK(plens != NULL);
+    DEBUG_CHECK(!messages_out || (mlens != NULL));
+    DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
+    DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
+    if (n <= 0) {
+        return 0;
+    }
+#ifndef USE_PTHREADS
+    nworkers = 1;
+    executor = NULL;
+#endif
+    if (nworkers < 1) {
+        nworkers = 1;
+    }
+    if (nworkers > n) {
+        nworkers = n;
+    }
+
+    scan.ctx = ctx;
+    scan.nonce_idx = nonce_idx;
+    scan.blinds_out = blinds_out;
+    scan.values_out = values_out;
+    scan.messages_out = messages_out;
+    scan.mlens = mlens;
+    scan.nonces = nonces;
+    scan.nnonces = nnonces;
+    scan.commits = commits;
+    scan.proofs = proofs;
+    scan.plens = plens;
+    size = ROUND_TO_ALIGN(SECP256K1_RANGEPROOF_SCRATCH_SIZE);
+    mem = (unsigned char *)checked_aligned_malloc(size * nworkers, 64);
+    scan.scratch = (secp256k1_scratch_space_t *)checked_malloc(sizeof(secp256k1_scratch_space_t) * nworkers);
+    for (w = 0; w < nworkers; w++) {
+        secp256k1_scratch_init(&scan.scratch[w], mem + size * w, size);
+    }
+
+    /* A proof at a time: one that matches a nonce costs a full verification, one that does not almost nothing. */
+    secp256k1_parallel_init(&par, nworkers, n, 1, secp256k1_rewind_scan_process, &scan);
+    if (executor != NULL) {
+        executor(secp256k1_parallel_worker, &par, nworkers, data);
+    } else {
+        secp256k1_parallel_run(&par);
+    }
+    secp256k1_parallel_clear(&par);
+
+    free(scan.scratch);
+    aligned_free(mem);
+    found = 0;
+    for (i = 0; i < n; i++) {
+        found += nonce_idx[i] >= 0;
+    }
+    return found;
+}
+
 int secp256k1_rangeproof_verify(const secp256k1_context_t* ctx, uint64_t *min_value, uint64_t *max_value,
  const unsigned char *commit, const unsigned char *proof, int plen) {
+    uint64_t mem[(SECP256K1_RANGEPROOF_SCRATCH_SIZE + 7) / 8];
+    secp256k1_scratch_space_t scratch;
     DEBUG_CHECK(ctx != NULL);
     DEBUG_CHECK(commit != NULL);
     DEBUG_CHECK(proof != NULL);
@@ -595,12 +1151,15 @@ int secp256k1_rangeproof_verify(const secp256k1_context_t* ctx, uint64_t *min_va
     DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
     DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
     DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
-    return secp256k1_rangeproof_verify_impl(&ctx->ecmult_ctx, NULL, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+    secp256k1_scratch_init(&scratch, mem, sizeof(mem));
+    return secp256k1_rangeproof_verify_impl(&scratch, &ctx->ecmult_ctx, NULL, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
      NULL, NULL, NULL, NULL, NULL, min_value, max_value, commit, proof, plen);
 }
 
 int secp256k1_rangeproof_sign(const secp256k1_context_t* ctx, unsigned char *proof, int *plen, uint64_t min_value,
  const unsigned char *commit, const unsigned char *blind, const unsigned char *nonce, int exp, int min_bits, uint64_t value){
+    uint64_t mem[(SECP256K1_RANGEPROOF_SCRATCH_SIZE + 7) / 8];
+    secp256k1_scratch_space_t scratch;
     DEBUG_CHECK(ctx != NULL);
     DEBUG_CHECK(proof != NULL);
     DEBUG_CHECK(plen != NULL);
@@ -611,6 +1170,508 @@ int secp256k1_rangeproof_sign(const secp256k1_context_t* ctx, unsigned char *pro
     DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
     DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
     DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
-    return secp256k1_rangeproof_sign_impl(&ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
-     proof, plen, min_value, commit, blind, nonce, exp, min_bits, value);
+    secp256k1_scratch_init(&scratch, mem, sizeof(mem));
+    return secp256k1_rangeproof_sign_impl(&scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+     proof, plen, min_value, commit, blind, nonce, exp, min_bits, value, 0);
+}
+
+int secp256k1_rangeproof_sign_compact(const secp256k1_context_t* ctx, unsigned char *proof, int *plen, uint64_t min_value,
+ const unsigned char *commit, const unsigned char *blind, const unsigned char *nonce, int exp, int min_bits, uint64_t value){
+    uint64_t mem[(SECP256K1_RANGEPROOF_SCRATCH_SIZE + 7) / 8];
+    secp256k1_scratch_space_t scratch;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(proof != NULL);
+    DEBUG_CHECK(plen != NULL);
+    DEBUG_CHECK(commit != NULL);
+    DEBUG_CHECK(blind != NULL);
+    DEBUG_CHECK(nonce != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
+    DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
+    secp256k1_scratch_init(&scratch, mem, sizeof(mem));
+    return secp256k1_rangeproof_sign_impl(&scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+     proof, plen, min_value, commit, blind, nonce, exp, min_bits, value, 1);
+}
+
+size_t secp256k1_rangeproof_scratch_size(const secp256k1_context_t* ctx) {
+    (void)ctx;
+    return SECP256K1_RANGEPROOF_SCRATCH_SIZE;
+}
+
+int secp256k1_rangeproof_verify_scratch(const secp256k1_context_t* ctx, secp256k1_scratch_space_t* scratch,
+ uint64_t *min_value, uint64_t *max_value, const unsigned char *commit, const unsigned char *proof, int plen) {
+    size_t checkpoint;
+    int ret;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(scratch != NULL);
+    DEBUG_CHECK(commit != NULL);
+    DEBUG_CHECK(proof != NULL);
+    DEBUG_CHECK(min_value != NULL);
+    DEBUG_CHECK(max_value != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
+    DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
+    checkpoint = secp256k1_scratch_checkpoint(scratch);
+    ret = secp256k1_rangeproof_verify_impl(scratch, &ctx->ecmult_ctx, NULL, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+     NULL, NULL, NULL, NULL, NULL, min_value, max_value, commit, proof, plen);
+    secp256k1_scratch_apply_checkpoint(scratch, checkpoint);
+    return ret;
+}
+
+int secp256k1_rangeproof_rewind_scratch(const secp256k1_context_t* ctx, secp256k1_scratch_space_t* scratch,
+ unsigned char *blind_out, uint64_t *value_out, unsigned char *message_out, int *outlen, const unsigned char *nonce,
+ uint64_t *min_value, uint64_t *max_value,
+ const unsigned char *commit, const unsigned char *proof, int plen) {
+    size_t checkpoint;
+    int ret;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(scratch != NULL);
+    DEBUG_CHECK(commit != NULL);
+    DEBUG_CHECK(proof != NULL);
+    DEBUG_CHECK(min_value != NULL);
+    DEBUG_CHECK(max_value != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
+    DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
+    checkpoint = secp256k1_scratch_checkpoint(scratch);
+    ret = secp256k1_rangeproof_verify_impl(scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+     blind_out, value_out, message_out, outlen, nonce, min_value, max_value, commit, proof, plen);
+    /* Rewinding leaves the recovered blinding factors and the prover's random stream in the frames. */
+    secp256k1_scratch_clear_to_checkpoint(scratch, checkpoint);
+    return ret;
+}
+
+int secp256k1_rangeproof_sign_scratch(const secp256k1_context_t* ctx, secp256k1_scratch_space_t* scratch,
+ unsigned char *proof, int *plen, uint64_t min_value, const unsigned char *commit, const unsigned char *blind,
+ const unsigned char *nonce, int exp, int min_bits, uint64_t value, int compact) {
+    size_t checkpoint;
+    int ret;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(scratch != NULL);
+    DEBUG_CHECK(proof != NULL);
+    DEBUG_CHECK(plen != NULL);
+    DEBUG_CHECK(commit != NULL);
+    DEBUG_CHECK(blind != NULL);
+    DEBUG_CHECK(nonce != NULL);
+    DEBUG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    DEBUG_CHECK(secp256k1_ecmult_gen2_context_is_built(&ctx->ecmult_gen2_ctx));
+    DEBUG_CHECK(secp256k1_rangeproof_context_is_built(&ctx->rangeproof_ctx));
+    checkpoint = secp256k1_scratch_checkpoint(scratch);
+    ret = secp256k1_rangeproof_sign_impl(scratch, &ctx->ecmult_ctx, &ctx->ecmult_gen_ctx, &ctx->ecmult_gen2_ctx, &ctx->rangeproof_ctx,
+     proof, plen, min_value, commit, blind, nonce, exp, min_bits, value, compact != 0);
+    /* Also on failure, the frame may hold the digit blinding factors and the ring nonces. */
+    secp256k1_scratch_clear_to_checkpoint(scratch, checkpoint);
+    return ret;
+}
+
+typedef struct {
+    const secp256k1_context_t *ctx;
+    secp256k1_verify_job_t *jobs;
+    secp256k1_scratch_space_t *scratch; /* one per worker, for the range proof temporaries */
+} secp256k1_verify_batch_t;
+
+static void secp256k1_verify_job_run(const secp256k1_context_t *ctx, secp256k1_scratch_space_t *scratch, secp256k1_verify_job_t *job) {
+    switch (job->type) {
+    case SECP256K1_VERIFY_JOB_ECDSA:
+        job->result = secp256k1_ecdsa_verify(ctx, job->u.ecdsa.msg32, job->u.ecdsa.sig, job->u.ecdsa.siglen,
+         job->u.ecdsa.pubkey, job->u.ecdsa.pubkeylen);
+        break;
+    case SECP256K1_VERIFY_JOB_RANGEPROOF:
+        job->result = secp256k1_rangeproof_verify_scratch(ctx, scratch, &job->u.rangeproof.min_value,
+         &job->u.rangeproof.max_value, job->u.rangeproof.commit, job->u.rangeproof.proof, job->u.rangeproof.plen);
+        break;
+    case SECP256K1_VERIFY_JOB_TALLY:
+        job->result = secp256k1_pedersen_verify_tally(ctx, job->u.tally.commits, job->u.tally.pcnt,
+         job->u.tally.ncommits, job->u.tally.ncnt, job->u.tally.excess);
+        break;
+    default:
+        job->result = 0;
+    }
+}
+
+/* How many jobs a worker takes at a time: the ECDSA ones among them are checked together, so that
+ * they share one inversion and can run through the lock-step multiplication. */
+#define SECP256K1_VERIFY_BATCH_GRAIN 4
+
+static void secp256k1_verify_batch_process(void *data, int worker, size_t begin, size_t end) {
+    const secp256k1_verify_batch_t *batch = (const secp256k1_verify_batch_t *)data;
+    secp256k1_ecdsa_sig_t sig[SECP256K1_VERIFY_BATCH_GRAIN];
+    secp256k1_ge_t pubkey[SECP256K1_VERIFY_BATCH_GRAIN];
+    secp256k1_scalar_t message[SECP256K1_VERIFY_BATCH_GRAIN];
+    secp256k1_scalar_t scratch[2 * SECP256K1_VERIFY_BATCH_GRAIN];
+    int ret[SECP256K1_VERIFY_BATCH_GRAIN];
+    size_t idx[SECP256K1_VERIFY_BATCH_GRAIN];
+    size_t i, k = 0;
+    VERIFY_CHECK(end - begin <= SECP256K1_VERIFY_BATCH_GRAIN);
+
+    /* Parse the ECDSA jobs the way secp256k1_ecdsa_verify does, and run the others right away. */
+    for (i = begin; i < end; i++) {
+        secp256k1_verify_job_t *job = &batch->jobs[i];
+        if (job->type != SECP256K1_VERIFY_JOB_ECDSA) {
+            secp256k1_verify_job_run(batch->ctx, batch->scratch != NULL ? &batch->scratch[worker] : NULL, job);
+        } else if (!secp256k1_eckey_pubkey_parse(&pubkey[k], job->u.ecdsa.pubkey, job->u.ecdsa.pubkeylen)) {
+            job->result = -1;
+        } else if (!secp256k1_ecdsa_sig_parse(&sig[k], job->u.ecdsa.sig, job->u.ecdsa.siglen)) {
+            job->result = -2;
+        } else {
+            secp256k1_scalar_set_b32(&message[k], job->u.ecdsa.msg32, NULL);
+            idx[k++] = i;
+        }
+    }
+
+    if (k == 0) {
+        return;
+    }
+    secp256k1_ecdsa_sig_verify_batch(&batch->ctx->ecmult_ctx, ret, k, sig, pubkey, message, scratch);
+    for (i = 0; i < k; i++) {
+        batch->jobs[idx[i]].result = ret[i];
+    }
+}
+
+int secp256k1_verify_batch_parallel(const secp256k1_context_t* ctx, secp256k1_verify_job_t *jobs, size_t n,
+ int nthreads, secp256k1_executor_function_t executor, void *data) {
+    secp256k1_verify_batch_t batch;
+    secp256k1_parallel_t par;
+    unsigned char *mem = NULL;
+    int nworkers = nthreads;
+    int w;
+    size_t i;
+    int ret = 1;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(jobs != NULL || n == 0);
+    if (n == 0) {
+        return 1;
+    }
+#ifndef USE_PTHREADS
+    nworkers = 1;
+    executor = NULL;
+#endif
+    if (nworkers < 1) {
+        nworkers = 1;
+    }
+    if ((size_t)nworkers > n) {
+        nworkers = (int)n;
+    }
+
+    batch.ctx = ctx;
+    batch.jobs = jobs;
+    batch.scratch = NULL;
+    for (i = 0; i < n; i++) {
+        if (jobs[i].type == SECP256K1_VERIFY_JOB_RANGEPROOF) {
+            break;
+        }
+    }
+    if (i < n) {
+        size_t size = ROUND_TO_ALIGN(SECP256K1_RANGEPROOF_SCRATCH_SIZE);
+        mem = (unsigned char *)checked_aligned_malloc(size * nworkers, 64);
+        batch.scratch = (secp256k1_scratch_space_t *)checked_malloc(sizeof(secp256k1_scratch_space_t) * nworkers);
+        for (w = 0; w < nworkers; w++) {
+            secp256k1_scratch_init(&batch.scratch[w], mem + size * w, size);
+        }
+    }
+
+    secp256k1_parallel_init(&par, nworkers, n, SECP256K1_VERIFY_BATCH_GRAIN, secp256k1_verify_batch_process, &batch);
+    if (executor != NULL) {
+        executor(secp256k1_parallel_worker, &par, nworkers, data);
+    } else {
+        secp256k1_parallel_run(&par);
+    }
+    secp256k1_parallel_clear(&par);
+
+    free(batch.scratch);
+    aligned_free(mem);
+    for (i = 0; i < n; i++) {
+        ret &= jobs[i].result == 1;
+    }
+    return ret;
+}
+
+typedef struct {
+    secp256k1_verifier_t *verifier;
+    secp256k1_scratch_space_t scratch;
+#ifdef USE_PTHREADS
+    pthread_t thread;
+#endif
+} secp256k1_verifier_worker_t;
+
+struct secp256k1_verifier_struct {
+    const secp256k1_context_t *ctx;
+    secp256k1_verify_callback_t callback;
+    void *data;
+    size_t capacity;
+    size_t outstanding; /* submitted, and not yet through the callback or polled */
+    int fd; /* eventfd signalled when the ring becomes non-empty, or -1 */
+    /* Finished jobs awaiting secp256k1_verifier_poll, when there is no callback. */
+    secp256k1_verify_job_t **ring;
+    size_t ring_start;
+    size_t ring_count;
+    unsigned char *mem; /* backs the workers' scratch spaces */
+    secp256k1_verifier_worker_t *workers;
+    int nworkers;
+#ifdef USE_PTHREADS
+    secp256k1_job_queue_t queue;
+    size_t pending; /* pushed onto the queue, or about to be, and not yet popped */
+    int idle; /* workers waiting on wake */
+    int stop;
+    pthread_mutex_t lock; /* held by the queue's consumer, and by workers going to sleep */
+    pthread_cond_t wake;
+    pthread_mutex_t ring_lock;
+#endif
+};
+
+static void secp256k1_verifier_complete(secp256k1_verifier_t *verifier, secp256k1_verify_job_t *job) {
+    int notify;
+    if (verifier->callback != NULL) {
+        verifier->callback(job, verifier->data);
+#ifdef USE_PTHREADS
+        SECP256K1_ATOMIC_SUB(&verifier->outstanding, 1);
+#else
+        verifier->outstanding--;
+#endif
+        return;
+    }
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_lock(&verifier->ring_lock) == 0);
+#endif
+    /* outstanding never exceeds capacity, so there is always room. */
+    VERIFY_CHECK(verifier->ring_count < verifier->capacity);
+    verifier->ring[(verifier->ring_start + verifier->ring_count) % verifier->capacity] = job;
+    notify = verifier->ring_count++ == 0;
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_unlock(&verifier->ring_lock) == 0);
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+    if (notify) {
+        uint64_t one = 1;
+        if (write(verifier->fd, &one, sizeof(one)) < 0) {
+            /* The counter is about to overflow, so the descriptor is readable anyway. */
+            VERIFY_CHECK(errno == EAGAIN);
+        }
+    }
+#else
+    (void)notify;
+#endif
+}
+
+#ifdef USE_PTHREADS
+static void *secp256k1_verifier_thread_main(void *arg) {
+    secp256k1_verifier_worker_t *worker = (secp256k1_verifier_worker_t *)arg;
+    secp256k1_verifier_t *verifier = worker->verifier;
+    secp256k1_verify_job_t *job;
+    for (;;) {
+        CHECK(pthread_mutex_lock(&verifier->lock) == 0);
+        for (;;) {
+            job = secp256k1_job_queue_pop(&verifier->queue);
+            if (job != NULL) {
+                SECP256K1_ATOMIC_SUB(&verifier->pending, 1);
+                break;
+            }
+            if (SECP256K1_ATOMIC_LOAD(&verifier->pending) != 0) {
+                /* A submitter is half way through linking the next job in. */
+                CHECK(pthread_mutex_unlock(&verifier->lock) == 0);
+                sched_yield();
+                CHECK(pthread_mutex_lock(&verifier->lock) == 0);
+            } else if (verifier->stop) {
+                break;
+            } else {
+                /* Announce the sleep before the last look at pending; a submitter increments pending
+                 * before looking at idle, so one of the two sees the other. */
+                SECP256K1_ATOMIC_ADD(&verifier->idle, 1);
+                if (SECP256K1_ATOMIC_LOAD(&verifier->pending) == 0) {
+                    CHECK(pthread_cond_wait(&verifier->wake, &verifier->lock) == 0);
+                }
+                SECP256K1_ATOMIC_SUB(&verifier->idle, 1);
+            }
+        }
+        CHECK(pthread_mutex_unlock(&verifier->lock) == 0);
+        if (job == NULL) {
+            return NULL;
+        }
+        secp256k1_verify_job_run(verifier->ctx, &worker->scratch, job);
+        secp256k1_verifier_complete(verifier, job);
+    }
+}
+#endif
+
+secp256k1_verifier_t* secp256k1_verifier_create(const secp256k1_context_t* ctx, int nthreads, size_t capacity,
+ secp256k1_verify_callback_t callback, void *data) {
+    secp256k1_verifier_t *verifier;
+    size_t size = ROUND_TO_ALIGN(SECP256K1_RANGEPROOF_SCRATCH_SIZE);
+    int w;
+    DEBUG_CHECK(ctx != NULL);
+    DEBUG_CHECK(capacity > 0);
+#ifdef USE_PTHREADS
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+#else
+    nthreads = 1;
+#endif
+
+    verifier = (secp256k1_verifier_t *)checked_malloc(sizeof(secp256k1_verifier_t));
+    verifier->ctx = ctx;
+    verifier->callback = callback;
+    verifier->data = data;
+    verifier->capacity = capacity;
+    verifier->outstanding = 0;
+    verifier->fd = -1;
+    verifier->ring = NULL;
+    verifier->ring_start = 0;
+    verifier->ring_count = 0;
+    if (callback == NULL) {
+        verifier->ring = (secp256k1_verify_job_t **)checked_malloc(sizeof(secp256k1_verify_job_t *) * capacity);
+#ifdef HAVE_SYS_EVENTFD_H
+        verifier->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (verifier->fd < 0) {
+            free(verifier->ring);
+            free(verifier);
+            return NULL;
+        }
+#endif
+    }
+    verifier->mem = (unsigned char *)checked_aligned_malloc(size * nthreads, 64);
+    verifier->workers = (secp256k1_verifier_worker_t *)checked_malloc(sizeof(secp256k1_verifier_worker_t) * nthreads);
+    for (w = 0; w < nthreads; w++) {
+        verifier->workers[w].verifier = verifier;
+        secp256k1_scratch_init(&verifier->workers[w].scratch, verifier->mem + size * w, size);
+    }
+    verifier->nworkers = nthreads;
+
+#ifdef USE_PTHREADS
+    secp256k1_job_queue_init(&verifier->queue);
+    verifier->pending = 0;
+    verifier->idle = 0;
+    verifier->stop = 0;
+    CHECK(pthread_mutex_init(&verifier->lock, NULL) == 0);
+    CHECK(pthread_cond_init(&verifier->wake, NULL) == 0);
+    CHECK(pthread_mutex_init(&verifier->ring_lock, NULL) == 0);
+    for (w = 0; w < nthreads; w++) {
+        if (pthread_create(&verifier->workers[w].thread, NULL, secp256k1_verifier_thread_main, &verifier->workers[w]) != 0) {
+            break;
+        }
+    }
+    /* Run with the workers that did start, if any did. */
+    verifier->nworkers = w;
+    if (w == 0) {
+        secp256k1_verifier_destroy(verifier);
+        return NULL;
+    }
+#endif
+    return verifier;
+}
+
+void secp256k1_verifier_destroy(secp256k1_verifier_t* verifier) {
+#ifdef USE_PTHREADS
+    int w;
+#endif
+    DEBUG_CHECK(verifier != NULL);
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_lock(&verifier->lock) == 0);
+    verifier->stop = 1;
+    CHECK(pthread_cond_broadcast(&verifier->wake) == 0);
+    CHECK(pthread_mutex_unlock(&verifier->lock) == 0);
+    for (w = 0; w < verifier->nworkers; w++) {
+        CHECK(pthread_join(verifier->workers[w].thread, NULL) == 0);
+    }
+    pthread_mutex_destroy(&verifier->ring_lock);
+    pthread_cond_destroy(&verifier->wake);
+    pthread_mutex_destroy(&verifier->lock);
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+    if (verifier->fd >= 0) {
+        close(verifier->fd);
+    }
+#endif
+    free(verifier->workers);
+    aligned_free(verifier->mem);
+    free(verifier->ring);
+    free(verifier);
+}
+
+int secp256k1_verifier_submit(secp256k1_verifier_t* verifier, secp256k1_verify_job_t *job) {
+#ifdef USE_PTHREADS
+    size_t outstanding;
+#endif
+    DEBUG_CHECK(verifier != NULL);
+    DEBUG_CHECK(job != NULL);
+#ifdef USE_PTHREADS
+    outstanding = SECP256K1_ATOMIC_LOAD(&verifier->outstanding);
+    do {
+        if (outstanding == verifier->capacity) {
+            return 0;
+        }
+    } while (!SECP256K1_ATOMIC_CAS(&verifier->outstanding, &outstanding, outstanding + 1));
+    /* Count the job before it can be popped, so that pending never drops below zero. */
+    SECP256K1_ATOMIC_ADD(&verifier->pending, 1);
+    secp256k1_job_queue_push(&verifier->queue, job);
+    if (SECP256K1_ATOMIC_LOAD(&verifier->idle) != 0) {
+        CHECK(pthread_mutex_lock(&verifier->lock) == 0);
+        CHECK(pthread_cond_signal(&verifier->wake) == 0);
+        CHECK(pthread_mutex_unlock(&verifier->lock) == 0);
+    }
+#else
+    if (verifier->outstanding == verifier->capacity) {
+        return 0;
+    }
+    verifier->outstanding++;
+    secp256k1_verify_job_run(verifier->ctx, &verifier->workers[0].scratch, job);
+    secp256k1_verifier_complete(verifier, job);
+#endif
+    return 1;
+}
+
+int secp256k1_verifier_fd(const secp256k1_verifier_t* verifier) {
+    DEBUG_CHECK(verifier != NULL);
+    return verifier->fd;
+}
+
+size_t secp256k1_verifier_poll(secp256k1_verifier_t* verifier, secp256k1_verify_job_t **jobs, size_t max) {
+    size_t i, n;
+    int more;
+    DEBUG_CHECK(verifier != NULL);
+    DEBUG_CHECK(jobs != NULL);
+    if (verifier->callback != NULL) {
+        return 0;
+    }
+#ifdef HAVE_SYS_EVENTFD_H
+    {
+        /* Clear the notification before looking, so a job finishing from here on raises a new one. */
+        uint64_t count;
+        if (read(verifier->fd, &count, sizeof(count)) < 0) {
+            /* There was nothing to clear. */
+            VERIFY_CHECK(errno == EAGAIN);
+        }
+    }
+#endif
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_lock(&verifier->ring_lock) == 0);
+#endif
+    n = verifier->ring_count < max ? verifier->ring_count : max;
+    for (i = 0; i < n; i++) {
+        jobs[i] = verifier->ring[(verifier->ring_start + i) % verifier->capacity];
+    }
+    verifier->ring_start = (verifier->ring_start + n) % verifier->capacity;
+    verifier->ring_count -= n;
+    more = verifier->ring_count != 0;
+#ifdef USE_PTHREADS
+    CHECK(pthread_mutex_unlock(&verifier->ring_lock) == 0);
+    SECP256K1_ATOMIC_SUB(&verifier->outstanding, n);
+#else
+    verifier->outstanding -= n;
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+    if (more) {
+        /* Leave the descriptor readable for the jobs that did not fit. */
+        uint64_t one = 1;
+        if (write(verifier->fd, &one, sizeof(one)) < 0) {
+            VERIFY_CHECK(errno == EAGAIN);
+        }
+    }
+#else
+    (void)more;
+#endif
+    return n;
 }
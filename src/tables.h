@@ -0,0 +1,39 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_TABLES_
+#define _SECP256K1_TABLES_
+
+#if defined HAVE_CONFIG_H
+#include "libsecp256k1-config.h"
+#endif
+
+#include "util.h"
+
+/** Size and alignment of the block holding all of a context's precomputed tables. */
+#define SECP256K1_HUGEPAGE_SIZE ((size_t)2 << 20)
+
+/** One block holding all precomputed tables of a context. The sub-contexts carve their tables out of
+ *  it with manual_alloc, and only the owner of the block frees it. */
+typedef struct {
+    void *data;
+    size_t size;
+    size_t mapped; /* length of the anonymous mapping, or 0 if data came from checked_aligned_malloc */
+    int owned;     /* whether secp256k1_tables_free releases data; not for caller-provided memory */
+    int mode;      /* SECP256K1_TABLES_* that describes the pages actually backing data */
+} secp256k1_tables_t;
+
+/** Allocate a 2 MiB-aligned block of size bytes (size may be 0, giving data == NULL). If hugepages is
+ *  set, try explicit hugetlb pages first, then an anonymous mapping advised with MADV_HUGEPAGE, and
+ *  fall back to ordinary memory when neither is available. */
+static void secp256k1_tables_alloc(secp256k1_tables_t *t, size_t size, int hugepages);
+
+/** Use size bytes of caller-provided memory at data as the block. It is never freed here. */
+static void secp256k1_tables_set(secp256k1_tables_t *t, void *data, size_t size);
+
+static void secp256k1_tables_free(secp256k1_tables_t *t);
+
+#endif
@@ -0,0 +1,91 @@
+/**********************************************************************
+ * Copyright (c) 2026 agent                                           *
+ * Distributed under the MIT software license, see the accompanying   *
+ * file COPYING or http://www.opensource.org/licenses/mit-license.php.*
+ **********************************************************************/
+
+#ifndef _SECP256K1_TABLES_IMPL_H_
+#define _SECP256K1_TABLES_IMPL_H_
+
+#include "tables.h"
+
+#if defined(USE_HUGEPAGES)
+#include <sys/mman.h>
+
+/* Map len (a multiple of SECP256K1_HUGEPAGE_SIZE) bytes of anonymous memory on a 2 MiB boundary. */
+static void *secp256k1_tables_map(size_t len, int *mode) {
+    unsigned char *base;
+    size_t head;
+#if defined(MAP_HUGETLB)
+    base = (unsigned char *)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if ((void *)base != MAP_FAILED) {
+        *mode = SECP256K1_TABLES_HUGETLB;
+        return base;
+    }
+#endif
+    /* No reserved huge pages: over-map by one huge page and trim, so the kernel can back the aligned
+     * remainder with transparent huge pages. */
+    base = (unsigned char *)mmap(NULL, len + SECP256K1_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)base == MAP_FAILED) {
+        return NULL;
+    }
+    head = (SECP256K1_HUGEPAGE_SIZE - ((size_t)base & (SECP256K1_HUGEPAGE_SIZE - 1))) & (SECP256K1_HUGEPAGE_SIZE - 1);
+    if (head != 0) {
+        munmap(base, head);
+    }
+    munmap(base + head + len, SECP256K1_HUGEPAGE_SIZE - head);
+    *mode = madvise(base + head, len, MADV_HUGEPAGE) == 0 ? SECP256K1_TABLES_THP : SECP256K1_TABLES_DEFAULT;
+    return base + head;
+}
+#endif
+
+static void secp256k1_tables_alloc(secp256k1_tables_t *t, size_t size, int hugepages) {
+    t->data = NULL;
+    t->size = size;
+    t->mapped = 0;
+    t->owned = size != 0;
+    t->mode = SECP256K1_TABLES_DEFAULT;
+    if (size == 0) {
+        return;
+    }
+#if defined(USE_HUGEPAGES)
+    if (hugepages) {
+        size_t len = (size + SECP256K1_HUGEPAGE_SIZE - 1) & ~(SECP256K1_HUGEPAGE_SIZE - 1);
+        t->data = secp256k1_tables_map(len, &t->mode);
+        if (t->data != NULL) {
+            t->mapped = len;
+            return;
+        }
+    }
+#else
+    (void)hugepages;
+#endif
+    t->data = checked_aligned_malloc(size, SECP256K1_HUGEPAGE_SIZE);
+}
+
+static void secp256k1_tables_set(secp256k1_tables_t *t, void *data, size_t size) {
+    t->data = size != 0 ? data : NULL;
+    t->size = size;
+    t->mapped = 0;
+    t->owned = 0;
+    t->mode = SECP256K1_TABLES_DEFAULT;
+}
+
+static void secp256k1_tables_free(secp256k1_tables_t *t) {
+    if (t->owned) {
+#if defined(USE_HUGEPAGES)
+        if (t->mapped != 0) {
+            munmap(t->data, t->mapped);
+        } else
+#endif
+        {
+            aligned_free(t->data);
+        }
+    }
+    t->data = NULL;
+    t->size = 0;
+    t->mapped = 0;
+    t->owned = 0;
+}
+
+#endif
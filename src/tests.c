@@ -16,6 +16,17 @@
 #include "secp256k1.c"
 #include "testrand_impl.h"
 
+#if defined(USE_ASM_X86_64) && defined(USE_FIELD_5X52)
+/* Also pull in the portable field multiplication, under different names, to cross-check the
+ * assembly against it. */
+#undef _SECP256K1_FIELD_INNER5X52_IMPL_H_
+#define secp256k1_fe_mul_inner secp256k1_fe_mul_inner_c
+#define secp256k1_fe_sqr_inner secp256k1_fe_sqr_inner_c
+#include "field_5x52_int128_impl.h"
+#undef secp256k1_fe_mul_inner
+#undef secp256k1_fe_sqr_inner
+#endif
+
 #ifdef ENABLE_OPENSSL_TESTS
 #include "openssl/bn.h"
 #include "openssl/ec.h"
@@ -154,6 +165,7 @@ void run_context_tests(void) {
     secp256k1_context_t *sign = secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
     secp256k1_context_t *vrfy = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY);
     secp256k1_context_t *both = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_COMMIT | SECP256K1_CONTEXT_RANGEPROOF);
+    secp256k1_context_t *huge = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_HUGEPAGES);
 
     secp256k1_gej_t pubj;
     secp256k1_ge_t pub;
@@ -168,8 +180,16 @@ void run_context_tests(void) {
         ctx_tmp = sign; sign = secp256k1_context_clone(sign); secp256k1_context_destroy(ctx_tmp);
         ctx_tmp = vrfy; vrfy = secp256k1_context_clone(vrfy); secp256k1_context_destroy(ctx_tmp);
         ctx_tmp = both; both = secp256k1_context_clone(both); secp256k1_context_destroy(ctx_tmp);
+        ctx_tmp = huge; huge = secp256k1_context_clone(huge); secp256k1_context_destroy(ctx_tmp);
     }
 
+    /*** only a context that asked for huge pages may get them, and the G tables start on a 2 MiB boundary ***/
+    CHECK(secp256k1_context_tables_mode(none) == SECP256K1_TABLES_DEFAULT);
+    CHECK(secp256k1_context_tables_mode(both) == SECP256K1_TABLES_DEFAULT);
+    CHECK(secp256k1_context_tables_mode(huge) >= SECP256K1_TABLES_DEFAULT && secp256k1_context_tables_mode(huge) <= SECP256K1_TABLES_HUGETLB);
+    CHECK(((size_t)vrfy->ecmult_ctx.pre_g & (SECP256K1_HUGEPAGE_SIZE - 1)) == 0);
+    CHECK(((size_t)huge->ecmult_ctx.pre_g & (SECP256K1_HUGEPAGE_SIZE - 1)) == 0);
+
     /*** attempt to use them ***/
     random_scalar_order_test(&msg);
     random_scalar_order_test(&key);
@@ -188,12 +208,61 @@ void run_context_tests(void) {
     /* try verifying */
     CHECK(secp256k1_ecdsa_sig_verify(&vrfy->ecmult_ctx, &sig, &pub, &msg));
     CHECK(secp256k1_ecdsa_sig_verify(&both->ecmult_ctx, &sig, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_sign(&huge->ecmult_gen_ctx, &sig, &key, &msg, &nonce, NULL));
+    CHECK(secp256k1_ecdsa_sig_verify(&huge->ecmult_ctx, &sig, &pub, &msg));
 
     /* cleanup */
     secp256k1_context_destroy(none);
     secp256k1_context_destroy(sign);
     secp256k1_context_destroy(vrfy);
     secp256k1_context_destroy(both);
+    secp256k1_context_destroy(huge);
+}
+
+void run_context_preallocated_tests(void) {
+    const int flags = SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_RANGEPROOF;
+    size_t size = secp256k1_context_preallocated_size(flags);
+    void *buf = checked_aligned_malloc(size, 64);
+    void *buf2 = checked_aligned_malloc(size, 64);
+    secp256k1_context_t *pre, *copy, *heap;
+    secp256k1_gej_t pubj;
+    secp256k1_ge_t pub;
+    secp256k1_scalar_t msg, key, nonce;
+    secp256k1_ecdsa_sig_t sig;
+
+    CHECK(secp256k1_context_preallocated_size(0) < secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN));
+    CHECK(secp256k1_context_preallocated_size(SECP256K1_CONTEXT_SIGN) < size);
+    CHECK(secp256k1_context_preallocated_size(flags | SECP256K1_CONTEXT_HUGEPAGES) == size);
+
+    /* The context and all its tables live in the buffer, tables first. */
+    pre = secp256k1_context_preallocated_create(buf, flags);
+    CHECK((unsigned char *)pre > (unsigned char *)buf && (unsigned char *)(pre + 1) == (unsigned char *)buf + size);
+    CHECK((void *)pre->ecmult_ctx.pre_g == buf);
+    CHECK(secp256k1_context_tables_mode(pre) == SECP256K1_TABLES_DEFAULT);
+
+    /* Clones in either direction carry the same tables. */
+    CHECK(secp256k1_context_preallocated_clone_size(pre) == size);
+    copy = secp256k1_context_preallocated_clone(pre, buf2);
+    heap = secp256k1_context_clone(copy);
+    CHECK(memcmp(copy->ecmult_ctx.pre_g, pre->ecmult_ctx.pre_g, SECP256K1_ECMULT_CONTEXT_TABLE_SIZE) == 0);
+    CHECK(memcmp(heap->rangeproof_ctx.prec, pre->rangeproof_ctx.prec, SECP256K1_RANGEPROOF_CONTEXT_TABLE_SIZE) == 0);
+    secp256k1_context_preallocated_destroy(pre);
+    memset(buf, 0, size);
+
+    random_scalar_order_test(&msg);
+    random_scalar_order_test(&key);
+    secp256k1_ecmult_gen(&copy->ecmult_gen_ctx, &pubj, &key);
+    secp256k1_ge_set_gej(&pub, &pubj);
+    do {
+        random_scalar_order_test(&nonce);
+    } while(!secp256k1_ecdsa_sig_sign(&copy->ecmult_gen_ctx, &sig, &key, &msg, &nonce, NULL));
+    CHECK(secp256k1_ecdsa_sig_verify(&copy->ecmult_ctx, &sig, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&heap->ecmult_ctx, &sig, &pub, &msg));
+
+    secp256k1_context_preallocated_destroy(copy);
+    secp256k1_context_destroy(heap);
+    aligned_free(buf);
+    aligned_free(buf2);
 }
 
 /***** HASH TESTS *****/
@@ -234,6 +303,106 @@ void run_sha256_tests(void) {
     }
 }
 
+void run_sha256_transform_tests(void) {
+    uint32_t s1[8];
+    uint32_t s2[8];
+    uint32_t chunk[16];
+    int i;
+    int j;
+    for (i = 0; i < 100 * count; i++) {
+        for (j = 0; j < 8; j++) {
+            s1[j] = s2[j] = secp256k1_rand32();
+        }
+        for (j = 0; j < 16; j++) {
+            chunk[j] = secp256k1_rand32();
+        }
+        /* The dispatched transform must match the portable one, whichever implementation the CPU selected. */
+        secp256k1_sha256_transform_c(s1, chunk);
+        secp256k1_sha256_transform(s2, chunk);
+        CHECK(memcmp(s1, s2, sizeof(s1)) == 0);
+#if defined(USE_SHA256_SHANI)
+        if (secp256k1_cpu_has(SECP256K1_CPU_SHANI)) {
+            for (j = 0; j < 8; j++) {
+                s2[j] = s1[j];
+            }
+            secp256k1_sha256_transform_c(s1, chunk);
+            secp256k1_sha256_transform_shani(s2, chunk);
+            CHECK(memcmp(s1, s2, sizeof(s1)) == 0);
+        }
+#endif
+    }
+#if defined(USE_SHA256_SIMD)
+    /* The multi-stream hasher skips the interleaved transforms on SHA-NI machines, so check them directly. */
+    for (i = 0; i < 10 * count; i++) {
+        uint32_t s4[8][8];
+        uint32_t s8[8][8];
+        uint32_t c8[8][16];
+        uint32_t ref[8][8];
+        int l;
+        for (l = 0; l < 8; l++) {
+            for (j = 0; j < 8; j++) {
+                s4[l][j] = s8[l][j] = ref[l][j] = secp256k1_rand32();
+            }
+            for (j = 0; j < 16; j++) {
+                c8[l][j] = secp256k1_rand32();
+            }
+            secp256k1_sha256_transform_c(ref[l], c8[l]);
+        }
+        secp256k1_sha256_transform_4way(&s4[0], &c8[0]);
+        secp256k1_sha256_transform_4way(&s4[4], &c8[4]);
+        CHECK(memcmp(s4, ref, sizeof(s4)) == 0);
+        if (secp256k1_cpu_has(SECP256K1_CPU_AVX2)) {
+            secp256k1_sha256_transform_8way(s8, c8);
+            CHECK(memcmp(s8, ref, sizeof(s8)) == 0);
+        }
+    }
+#endif
+}
+
+void run_sha256_multi_tests(void) {
+    unsigned char data[SECP256K1_SHA256_MAX_LANES][200];
+    const unsigned char *ptrs[SECP256K1_SHA256_MAX_LANES];
+    unsigned char common[100];
+    unsigned char out[SECP256K1_SHA256_MAX_LANES * 32];
+    unsigned char out1[32];
+    secp256k1_sha256_multi_t multi;
+    secp256k1_sha256_t sha256;
+    int i;
+    int l;
+    for (i = 0; i < count; i++) {
+        int lanes = 1 + secp256k1_rand32() % SECP256K1_SHA256_MAX_LANES;
+        int len = secp256k1_rand32() % 200;
+        int split = len ? secp256k1_rand32() % len : 0;
+        int clen = secp256k1_rand32() % 100;
+        secp256k1_rand256(common);
+        secp256k1_rand256(common + 32);
+        secp256k1_rand256(common + 64);
+        for (l = 0; l < lanes; l++) {
+            int j;
+            for (j = 0; j < 200; j += 32) {
+                secp256k1_rand256_test(data[l] + (j < 168 ? j : 168));
+            }
+            ptrs[l] = data[l];
+        }
+        secp256k1_sha256_multi_initialize(&multi, lanes);
+        secp256k1_sha256_multi_write(&multi, ptrs, split);
+        for (l = 0; l < lanes; l++) {
+            ptrs[l] = data[l] + split;
+        }
+        secp256k1_sha256_multi_write_common(&multi, common, clen);
+        secp256k1_sha256_multi_write(&multi, ptrs, len - split);
+        secp256k1_sha256_multi_finalize(&multi, out);
+        for (l = 0; l < lanes; l++) {
+            secp256k1_sha256_initialize(&sha256);
+            secp256k1_sha256_write(&sha256, data[l], split);
+            secp256k1_sha256_write(&sha256, common, clen);
+            secp256k1_sha256_write(&sha256, data[l] + split, len - split);
+            secp256k1_sha256_finalize(&sha256, out1);
+            CHECK(memcmp(out1, out + 32 * l, 32) == 0);
+        }
+    }
+}
+
 void run_hmac_sha256_tests(void) {
     static const char *keys[6] = {
         "\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b\x0b",
@@ -685,6 +854,44 @@ void scalar_test(void) {
 
 }
 
+#if defined(USE_ASM_X86_64) && defined(USE_SCALAR_4X64)
+void test_scalar_asm(void) {
+    int i;
+    for (i = 0; i < 100*count; i++) {
+        secp256k1_scalar_t a, b, r, rc;
+        uint64_t l[8], lc[8];
+        int j;
+        random_scalar_order_test(&a);
+        random_scalar_order_test(&b);
+        secp256k1_scalar_mul_512_asm(l, &a, &b);
+        secp256k1_scalar_mul_512(lc, &a, &b);
+        CHECK(memcmp(l, lc, sizeof(l)) == 0);
+        secp256k1_scalar_reduce_512_asm(&r, l);
+        secp256k1_scalar_reduce_512(&rc, l);
+        CHECK(secp256k1_scalar_eq(&r, &rc));
+        /* Reduce arbitrary 512-bit values too, biased towards all-ones limbs. */
+        for (j = 0; j < 8; j++) {
+            l[j] = (secp256k1_rand32() & 1) ? ~(uint64_t)0 : (((uint64_t)secp256k1_rand32() << 32) | secp256k1_rand32());
+        }
+        secp256k1_scalar_reduce_512_asm(&r, l);
+        secp256k1_scalar_reduce_512(&rc, l);
+        CHECK(secp256k1_scalar_eq(&r, &rc));
+    }
+}
+
+void run_scalar_asm(void) {
+    test_scalar_asm();
+#if defined(USE_CPU_DISPATCH)
+    /* Also run the baseline multiplication on machines with BMI2/ADX. */
+    if (secp256k1_cpu_has(SECP256K1_CPU_BMI2)) {
+        secp256k1_cpu_disabled |= SECP256K1_CPU_BMI2;
+        test_scalar_asm();
+        secp256k1_cpu_disabled &= ~SECP256K1_CPU_BMI2;
+    }
+#endif
+}
+#endif
+
 void run_scalar_tests(void) {
     int i;
     for (i = 0; i < 128 * count; i++) {
@@ -856,6 +1063,148 @@ void run_field_misc(void) {
     }
 }
 
+#if defined(USE_ASM_X86_64) && defined(USE_FIELD_5X52)
+/* Random limbs at the maximum magnitude fe_mul_inner accepts, biased towards all-ones limbs. */
+void random_fe_inner_limbs(uint64_t *a) {
+    int i;
+    for (i = 0; i < 5; i++) {
+        int bits = (i == 4) ? 52 : 56;
+        a[i] = (secp256k1_rand32() & 3) ? (uint64_t)secp256k1_rands64(0, (1ULL << bits) - 1) : ((1ULL << bits) - 1);
+    }
+}
+
+void run_field_asm(void) {
+    uint64_t a[5], b[5], r[5], rc[5];
+    int i;
+    for (i = 0; i < 100*count; i++) {
+        random_fe_inner_limbs(a);
+        random_fe_inner_limbs(b);
+        secp256k1_fe_mul_inner(r, a, b);
+        secp256k1_fe_mul_inner_c(rc, a, b);
+        CHECK(memcmp(r, rc, sizeof(r)) == 0);
+        secp256k1_fe_sqr_inner(r, a);
+        secp256k1_fe_sqr_inner_c(rc, a);
+        CHECK(memcmp(r, rc, sizeof(r)) == 0);
+        /* The output may alias the (first) input. */
+        memcpy(r, a, sizeof(r));
+        secp256k1_fe_mul_inner(r, r, b);
+        secp256k1_fe_mul_inner_c(rc, a, b);
+        CHECK(memcmp(r, rc, sizeof(r)) == 0);
+        memcpy(r, a, sizeof(r));
+        secp256k1_fe_sqr_inner(r, r);
+        secp256k1_fe_sqr_inner_c(rc, a);
+        CHECK(memcmp(r, rc, sizeof(r)) == 0);
+    }
+}
+#endif
+
+void test_field_4way(void) {
+    secp256k1_fe_t a[4], b[4], r[4], x;
+    secp256k1_fe4_t a4, b4, r4;
+    int flag[4], zero[4];
+    int l;
+#if defined(USE_FIELD_10X26)
+    /* 10x26 limbs only have headroom up to magnitude 32. */
+    const int k = 2;
+#else
+    const int k = 3;
+#endif
+    for (l = 0; l < 4; l++) {
+        random_field_element_test(&a[l]);
+        random_field_element_magnitude(&a[l]);
+        random_field_element_test(&b[l]);
+        random_field_element_magnitude(&b[l]);
+        flag[l] = secp256k1_rand32() & 1;
+    }
+    if (secp256k1_rand32() & 1) {
+        /* The largest limbs a magnitude 8 input may have. */
+        int i;
+#if defined(USE_FIELD_10X26)
+        for (i = 0; i < 9; i++) {
+            a[0].n[i] = 0x3FFFFFFUL * 16;
+        }
+        a[0].n[9] = 0x03FFFFFUL * 16;
+#else
+        for (i = 0; i < 4; i++) {
+            a[0].n[i] = 0xFFFFFFFFFFFFFULL * 16;
+        }
+        a[0].n[4] = 0x0FFFFFFFFFFFFULL * 16;
+#endif
+#ifdef VERIFY
+        a[0].magnitude = 8;
+        a[0].normalized = 0;
+#endif
+    }
+    secp256k1_fe4_set_fe(&a4, a);
+    secp256k1_fe4_set_fe(&b4, b);
+
+    secp256k1_fe4_mul(&r4, &a4, &b4);
+    secp256k1_fe4_get_fe(r, &r4);
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_mul(&x, &a[l], &b[l]);
+        CHECK(check_fe_equal(&x, &r[l]));
+    }
+    r4 = a4;
+    secp256k1_fe4_sqr(&r4, &r4);
+    secp256k1_fe4_get_fe(r, &r4);
+    for (l = 0; l < 4; l++) {
+        secp256k1_fe_sqr(&x, &a[l]);
+        CHECK(check_fe_equal(&x, &r[l]));
+    }
+
+    r4 = a4;
+    secp256k1_fe4_add(&r4, &b4);
+    secp256k1_fe4_mul_int(&r4, k);
+    secp256k1_fe4_normalize_weak(&r4);
+    secp256k1_fe4_cmov(&r4, &a4, flag);
+    secp256k1_fe4_get_fe(r, &r4);
+    for (l = 0; l < 4; l++) {
+        x = a[l];
+        if (!flag[l]) {
+            secp256k1_fe_add(&x, &b[l]);
+            secp256k1_fe_mul_int(&x, k);
+        }
+        CHECK(check_fe_equal(&x, &r[l]));
+    }
+
+    /* a + (-a) normalizes to zero, a + (-b) only where a == b. */
+    for (l = 0; l < 4; l++) {
+        if (flag[l]) {
+            b[l] = a[l];
+        }
+    }
+    secp256k1_fe4_set_fe(&b4, b);
+    secp256k1_fe4_negate(&r4, &b4, 8);
+    secp256k1_fe4_add(&r4, &a4);
+    secp256k1_fe4_normalizes_to_zero(zero, &r4);
+    secp256k1_fe4_normalize(&r4);
+    secp256k1_fe4_get_fe(r, &r4);
+    for (l = 0; l < 4; l++) {
+        CHECK(zero[l] == flag[l]);
+        x = r[l];
+        secp256k1_fe_normalize(&x);
+        CHECK(memcmp(x.n, r[l].n, sizeof(x.n)) == 0);
+        CHECK(secp256k1_fe_is_zero(&x) == flag[l]);
+    }
+}
+
+void run_field_4way(void) {
+    int i;
+    for (i = 0; i < 10*count; i++) {
+        test_field_4way();
+    }
+#if defined(USE_FIELD_4WAY_IFMA) && defined(USE_FIELD_5X52)
+    /* Cover the portable kernels as well on machines with IFMA. */
+    if (secp256k1_cpu_has(SECP256K1_CPU_IFMA)) {
+        secp256k1_cpu_disabled |= SECP256K1_CPU_IFMA;
+        for (i = 0; i < 10*count; i++) {
+            test_field_4way();
+        }
+        secp256k1_cpu_disabled &= ~SECP256K1_CPU_IFMA;
+    }
+#endif
+}
+
 void run_field_inv(void) {
     secp256k1_fe_t x, xi, xii;
     int i;
@@ -902,6 +1251,129 @@ void run_field_inv_all_var(void) {
     }
 }
 
+void run_scalar_inv_all_var(void) {
+    secp256k1_scalar_t x[16], xi[16], xii[16], t;
+    int i;
+    /* Check it's safe to call for 0 elements */
+    secp256k1_scalar_inv_all_var(0, xi, x);
+    for (i = 0; i < count; i++) {
+        size_t j;
+        size_t len = (secp256k1_rand32() & 15) + 1;
+        for (j = 0; j < len; j++) {
+            random_scalar_order_test(&x[j]);
+        }
+        secp256k1_scalar_inv_all_var(len, xi, x);
+        for (j = 0; j < len; j++) {
+            secp256k1_scalar_inverse_var(&t, &x[j]);
+            CHECK(secp256k1_scalar_eq(&t, &xi[j]));
+        }
+        secp256k1_scalar_inv_all_var(len, xii, xi);
+        for (j = 0; j < len; j++) {
+            CHECK(secp256k1_scalar_eq(&x[j], &xii[j]));
+        }
+        /* The blinded constant-time version gives the same inverses, whatever the blind. */
+        random_scalar_order_test(&t);
+        secp256k1_scalar_inv_all(len, xii, x, &t);
+        for (j = 0; j < len; j++) {
+            CHECK(secp256k1_scalar_eq(&xi[j], &xii[j]));
+        }
+    }
+}
+
+/* Compute a^e for a 32-byte big-endian exponent e, by square-and-multiply. */
+void test_fe_pow(secp256k1_fe_t *r, const secp256k1_fe_t *a, const unsigned char *e32) {
+    int i;
+    secp256k1_fe_set_int(r, 1);
+    for (i = 0; i < 256; i++) {
+        secp256k1_fe_sqr(r, r);
+        if ((e32[i >> 3] >> (7 - (i & 7))) & 1) {
+            secp256k1_fe_mul(r, r, a);
+        }
+    }
+}
+
+void test_scalar_pow(secp256k1_scalar_t *r, const secp256k1_scalar_t *a, const unsigned char *e32) {
+    int i;
+    secp256k1_scalar_set_int(r, 1);
+    for (i = 0; i < 256; i++) {
+        secp256k1_scalar_sqr(r, r);
+        if ((e32[i >> 3] >> (7 - (i & 7))) & 1) {
+            secp256k1_scalar_mul(r, r, a);
+        }
+    }
+}
+
+void test_inverse_field(const unsigned char *b32) {
+    /* p - 2 */
+    static const unsigned char pm2[32] = {
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFE,0xFF,0xFF,0xFC,0x2D
+    };
+    secp256k1_fe_t x, xi, xv, xp;
+    if (!secp256k1_fe_set_b32(&x, b32)) {
+        return;
+    }
+    secp256k1_fe_inv(&xi, &x);
+    secp256k1_fe_inv_var(&xv, &x);
+    test_fe_pow(&xp, &x, pm2);
+    CHECK(check_fe_equal(&xi, &xp));
+    CHECK(check_fe_equal(&xv, &xp));
+}
+
+void test_inverse_scalar(const unsigned char *b32) {
+    /* n - 2 */
+    static const unsigned char nm2[32] = {
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,
+        0xBA,0xAE,0xDC,0xE6,0xAF,0x48,0xA0,0x3B,
+        0xBF,0xD2,0x5E,0x8C,0xD0,0x36,0x41,0x3F
+    };
+    secp256k1_scalar_t x, xi, xv, xp;
+    int overflow;
+    secp256k1_scalar_set_b32(&x, b32, &overflow);
+    if (overflow) {
+        return;
+    }
+    secp256k1_scalar_inverse(&xi, &x);
+    secp256k1_scalar_inverse_var(&xv, &x);
+    test_scalar_pow(&xp, &x, nm2);
+    CHECK(secp256k1_scalar_eq(&xi, &xp));
+    CHECK(secp256k1_scalar_eq(&xv, &xp));
+}
+
+void run_inverse_tests(void) {
+    /* Edge cases: 0, 1, 2, 2^255, and the moduli minus one and two. */
+    static const unsigned char edge[7][32] = {
+        {0},
+        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1},
+        {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2},
+        {0x80},
+        {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+         0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,0xFF,0xFF,0xFC,0x2E},
+        {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,
+         0xBA,0xAE,0xDC,0xE6,0xAF,0x48,0xA0,0x3B,0xBF,0xD2,0x5E,0x8C,0xD0,0x36,0x41,0x40},
+        {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,
+         0xBA,0xAE,0xDC,0xE6,0xAF,0x48,0xA0,0x3B,0xBF,0xD2,0x5E,0x8C,0xD0,0x36,0x41,0x3F}
+    };
+    unsigned char b32[32];
+    int i;
+    for (i = 0; i < 7; i++) {
+        test_inverse_field(edge[i]);
+        test_inverse_scalar(edge[i]);
+    }
+    for (i = 0; i < count; i++) {
+        /* Use inputs with long runs of zero and one bits, which stress the divstep bounds. */
+        secp256k1_rand256_test(b32);
+        test_inverse_field(b32);
+        test_inverse_scalar(b32);
+        secp256k1_rand256(b32);
+        test_inverse_field(b32);
+        test_inverse_scalar(b32);
+    }
+}
+
 void run_sqr(void) {
     secp256k1_fe_t x, s;
 
@@ -1181,6 +1653,7 @@ void test_ge(void) {
         secp256k1_fe_t *zr = (secp256k1_fe_t *)malloc((4 * runs + 1) * sizeof(secp256k1_fe_t));
         secp256k1_ge_t *ge_set_table = (secp256k1_ge_t *)malloc((4 * runs + 1) * sizeof(secp256k1_ge_t));
         secp256k1_ge_t *ge_set_all = (secp256k1_ge_t *)malloc((4 * runs + 1) * sizeof(secp256k1_ge_t));
+        secp256k1_ge_t *ge_set_all_ct = (secp256k1_ge_t *)malloc((4 * runs + 1) * sizeof(secp256k1_ge_t));
         for (i = 0; i < 4 * runs + 1; i++) {
             /* Compute gej[i + 1].z / gez[i].z (with gej[n].z taken to be 1). */
             if (i < 4 * runs) {
@@ -1189,13 +1662,19 @@ void test_ge(void) {
         }
         secp256k1_ge_set_table_gej_var(4 * runs + 1, ge_set_table, gej, zr);
         secp256k1_ge_set_all_gej_var(4 * runs + 1, ge_set_all, gej);
+        /* The constant-time version does not take the infinity in gej[0]. */
+        secp256k1_ge_set_all_gej(4 * runs, ge_set_all_ct + 1, gej + 1);
         for (i = 0; i < 4 * runs + 1; i++) {
             secp256k1_fe_t s;
             random_fe_non_zero(&s);
             secp256k1_gej_rescale(&gej[i], &s);
             ge_equals_gej(&ge_set_table[i], &gej[i]);
             ge_equals_gej(&ge_set_all[i], &gej[i]);
+            if (i > 0) {
+                ge_equals_gej(&ge_set_all_ct[i], &gej[i]);
+            }
         }
+        free(ge_set_all_ct);
         free(ge_set_table);
         free(ge_set_all);
         free(zr);
@@ -1213,6 +1692,47 @@ void run_ge(void) {
     }
 }
 
+void test_group_4way(void) {
+    secp256k1_ge_t a[4], b[4];
+    secp256k1_gej_t aj[4], rj[4], ref;
+    secp256k1_ge4_t b4;
+    secp256k1_gej4_t a4, r4;
+    int l;
+    for (l = 0; l < 4; l++) {
+        random_group_element_test(&a[l]);
+        random_group_element_jacobian_test(&aj[l], &a[l]);
+        random_group_element_test(&b[l]);
+    }
+    /* Lane 1 doubles, lane 2 starts at infinity, lane 3 adds up to infinity. */
+    b[1] = a[1];
+    aj[2].infinity = 1;
+    secp256k1_ge_neg(&b[3], &a[3]);
+
+    secp256k1_gej4_set_gej(&a4, aj);
+    secp256k1_ge4_set_ge(&b4, b);
+    secp256k1_gej4_add_ge(&r4, &a4, &b4);
+    secp256k1_gej4_get_gej(rj, &r4);
+    for (l = 0; l < 4; l++) {
+        secp256k1_gej_add_ge(&ref, &aj[l], &b[l]);
+        CHECK(gej_xyz_equals_gej(&ref, &rj[l]));
+    }
+    CHECK(rj[3].infinity);
+
+    secp256k1_gej4_double(&r4, &r4);
+    secp256k1_gej4_get_gej(aj, &r4);
+    for (l = 0; l < 4; l++) {
+        secp256k1_gej_double_var(&ref, &rj[l], NULL);
+        CHECK(gej_xyz_equals_gej(&ref, &aj[l]));
+    }
+}
+
+void run_group_4way(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_group_4way();
+    }
+}
+
 /***** ECDH TESTS *****/
 
 void ecdh_mult_zero(void) {
@@ -1465,7 +1985,7 @@ void run_point_times_order(void) {
 
 void test_wnaf(const secp256k1_scalar_t *number, int w) {
     secp256k1_scalar_t x, two, t;
-    int wnaf[256];
+    int16_t wnaf[256];
     int zeroes = -1;
     int i;
     int bits;
@@ -1556,9 +2076,21 @@ void run_wnaf(void) {
     for (i = 0; i < count; i++) {
         random_scalar_order(&n);
         test_wnaf(&n, 4+(i%10));
+        test_wnaf(&n, WINDOW_G);
         test_constant_wnaf_negate(&n);
         test_constant_wnaf(&n, 4 + (i % 10));
     }
+    /* Long runs of zero and one bits, which the encoder skips a word at a time. */
+    for (i = 0; i < count; i++) {
+        unsigned char b32[32];
+        int j;
+        for (j = 0; j < 32; j++) {
+            b32[j] = (secp256k1_rand32() & 1) ? 0xFF : 0;
+        }
+        b32[31] ^= secp256k1_rand32() & 0x7F;
+        secp256k1_scalar_set_b32(&n, b32, NULL);
+        test_wnaf(&n, 2 + (i % 15));
+    }
 }
 
 void test_ecmult_constants(void) {
@@ -1598,6 +2130,50 @@ void run_ecmult_constants(void) {
     test_ecmult_constants();
 }
 
+void test_ecmult_4way(void) {
+    /* The lock-step multiplication must agree with secp256k1_ecmult in every lane, including lanes
+     * with zero scalars and lanes whose result is the point at infinity. */
+    secp256k1_gej_t a[4], r[4], ref;
+    secp256k1_scalar_t na[4], ng[4];
+    secp256k1_ge_t ge;
+    int l;
+    for (l = 0; l < 4; l++) {
+        random_group_element_test(&ge);
+        random_group_element_jacobian_test(&a[l], &ge);
+        random_scalar_order_test(&na[l]);
+        random_scalar_order_test(&ng[l]);
+    }
+    switch (secp256k1_rand32() % 4) {
+    case 0:
+        secp256k1_scalar_set_int(&na[secp256k1_rand32() % 4], 0);
+        break;
+    case 1:
+        secp256k1_scalar_set_int(&ng[secp256k1_rand32() % 4], 0);
+        break;
+    case 2:
+        /* na*G - na*G */
+        l = secp256k1_rand32() % 4;
+        secp256k1_gej_set_ge(&a[l], &secp256k1_ge_const_g);
+        secp256k1_scalar_negate(&ng[l], &na[l]);
+        break;
+    }
+    secp256k1_ecmult_4way(&ctx->ecmult_ctx, r, a, na, ng);
+    for (l = 0; l < 4; l++) {
+        secp256k1_ecmult(&ctx->ecmult_ctx, &ref, &a[l], &na[l], &ng[l]);
+        CHECK(secp256k1_gej_is_infinity(&ref) == secp256k1_gej_is_infinity(&r[l]));
+        secp256k1_gej_neg(&ref, &ref);
+        secp256k1_gej_add_var(&ref, &ref, &r[l], NULL);
+        CHECK(secp256k1_gej_is_infinity(&ref));
+    }
+}
+
+void run_ecmult_4way(void) {
+    int i;
+    for (i = 0; i < 4 * count; i++) {
+        test_ecmult_4way();
+    }
+}
+
 void test_ecmult_gen_blind(void) {
     /* Test ecmult_gen() blinding and confirm that the blinding changes, the affline points match, and the z's don't match. */
     secp256k1_scalar_t key;
@@ -1641,6 +2217,22 @@ void run_ecmult_gen_blind(void) {
     }
 }
 
+void run_ecmult_gen_table_lookup(void) {
+    int i, j;
+    for (i = 0; i < 64; i++) {
+        for (j = 0; j < 16; j++) {
+            secp256k1_ge_storage_t r1, r2;
+            secp256k1_ecmult_gen_table_lookup(&r1, (*ctx->ecmult_gen_ctx.prec)[i], j);
+            CHECK(memcmp(&r1, &(*ctx->ecmult_gen_ctx.prec)[i][j], sizeof(r1)) == 0);
+            /* The portable scan must agree with whichever one the CPU selected. */
+            secp256k1_cpu_disabled = ~0;
+            secp256k1_ecmult_gen_table_lookup(&r2, (*ctx->ecmult_gen_ctx.prec)[i], j);
+            secp256k1_cpu_disabled = 0;
+            CHECK(memcmp(&r1, &r2, sizeof(r1)) == 0);
+        }
+    }
+}
+
 
 void random_sign(secp256k1_ecdsa_sig_t *sig, const secp256k1_scalar_t *key, const secp256k1_scalar_t *msg, int *recid) {
     secp256k1_scalar_t nonce;
@@ -1679,6 +2271,57 @@ void run_ecdsa_sign_verify(void) {
     }
 }
 
+void test_ecdsa_batch(void) {
+    secp256k1_ecdsa_sig_t sig[8];
+    secp256k1_ge_t pub[8], rec[8];
+    secp256k1_scalar_t msg[8], scratch[16];
+    int recid[8], ret[8];
+    size_t n = secp256k1_rand32() % 9;
+    size_t i;
+    /* Set up all eight items, and batch the first n of them. */
+    for (i = 0; i < 8; i++) {
+        secp256k1_gej_t pubj;
+        secp256k1_scalar_t key;
+        random_scalar_order_test(&msg[i]);
+        random_scalar_order_test(&key);
+        secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &pubj, &key);
+        secp256k1_ge_set_gej(&pub[i], &pubj);
+        random_sign(&sig[i], &key, &msg[i], &recid[i]);
+        switch (secp256k1_rand32() & 7) {
+        case 0:
+            /* Wrong message. */
+            random_scalar_order_test(&msg[i]);
+            break;
+        case 1:
+            secp256k1_scalar_clear(&sig[i].r);
+            break;
+        case 2:
+            secp256k1_scalar_clear(&sig[i].s);
+            break;
+        }
+    }
+    secp256k1_ecdsa_sig_verify_batch(&ctx->ecmult_ctx, ret, n, sig, pub, msg, scratch);
+    for (i = 0; i < n; i++) {
+        CHECK(ret[i] == secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sig[i], &pub[i], &msg[i]));
+    }
+    secp256k1_ecdsa_sig_recover_batch(&ctx->ecmult_ctx, ret, n, sig, rec, msg, recid, scratch);
+    for (i = 0; i < n; i++) {
+        secp256k1_ge_t r;
+        CHECK(ret[i] == secp256k1_ecdsa_sig_recover(&ctx->ecmult_ctx, &sig[i], &r, &msg[i], recid[i]));
+        if (ret[i]) {
+            ge_equals_ge(&r, &rec[i]);
+            CHECK(secp256k1_ecdsa_sig_verify(&ctx->ecmult_ctx, &sig[i], &rec[i], &msg[i]));
+        }
+    }
+}
+
+void run_ecdsa_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_batch();
+    }
+}
+
 /** Dummy nonce generation function that just uses a precomputed nonce, and fails if it is not accepted. Use only for testing. */
 static int precomputed_nonce_function(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, unsigned int counter, const void *data) {
     (void)msg32;
@@ -1725,6 +2368,161 @@ static int nonce_function_test_retry(unsigned char *nonce32, const unsigned char
    return nonce_function_rfc6979(nonce32, msg32, key32, counter - 5, data);
 }
 
+static int nonce_function_test_first(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, unsigned int counter, const void *data) {
+   /* Dummy nonce generator that starts with the nonce in data, and continues with RFC6979. */
+   if (counter == 0) {
+       memcpy(nonce32, data, 32);
+       return 1;
+   }
+   return nonce_function_rfc6979(nonce32, msg32, key32, counter, NULL);
+}
+
+void test_ecdsa_sign_batch(void) {
+    unsigned char msg[80][32];
+    unsigned char key[80][32];
+    unsigned char sig[80][72];
+    int siglen[80], buflen[80];
+    const unsigned char *mptr[80], *kptr[80];
+    unsigned char *sptr[80];
+    unsigned char ref[72];
+    int reflen;
+    unsigned char k32[32], sig64[64];
+    secp256k1_scalar_t k, d, m;
+    secp256k1_nonce_function_t noncefp = NULL;
+    const void *ndata = NULL;
+    size_t n = secp256k1_rand32() % 81;
+    size_t i;
+    int ret, all = 1;
+
+    random_scalar_order_test(&k);
+    secp256k1_scalar_get_b32(k32, &k);
+    for (i = 0; i < n; i++) {
+        random_scalar_order_test(&d);
+        secp256k1_scalar_get_b32(key[i], &d);
+        secp256k1_rand256_test(msg[i]);
+        buflen[i] = 72;
+        switch (secp256k1_rand32() & 7) {
+        case 0:
+            /* An invalid key. */
+            memset(key[i], (secp256k1_rand32() & 1) ? 0xFF : 0, 32);
+            break;
+        case 1:
+            /* A message for which the nonce k gives s = 0, so that it takes a second nonce. */
+            CHECK(secp256k1_ecdsa_sign_compact(ctx, msg[i], sig64, key[i], precomputed_nonce_function, k32, NULL));
+            secp256k1_scalar_set_b32(&m, sig64, NULL);
+            secp256k1_scalar_mul(&m, &m, &d);
+            secp256k1_scalar_negate(&m, &m);
+            secp256k1_scalar_get_b32(msg[i], &m);
+            break;
+        case 2:
+            /* No room for the signature. */
+            buflen[i] = 8;
+            break;
+        }
+        siglen[i] = buflen[i];
+        mptr[i] = msg[i];
+        kptr[i] = key[i];
+        sptr[i] = sig[i];
+    }
+    switch (secp256k1_rand32() % 3) {
+    case 0:
+        noncefp = nonce_function_test_first;
+        ndata = k32;
+        break;
+    case 1:
+        noncefp = nonce_function_test_retry;
+        break;
+    }
+
+    /* Every signature must match the one secp256k1_ecdsa_sign makes, and fail where it fails. */
+    ret = secp256k1_ecdsa_sign_batch(ctx, mptr, sptr, siglen, kptr, n, noncefp, ndata);
+    for (i = 0; i < n; i++) {
+        reflen = buflen[i];
+        all &= secp256k1_ecdsa_sign(ctx, msg[i], ref, &reflen, key[i], noncefp, ndata);
+        CHECK(siglen[i] == reflen);
+        CHECK(memcmp(sig[i], ref, reflen) == 0);
+    }
+    CHECK(ret == all);
+}
+
+void run_presig_pool(void) {
+    unsigned char seed[32], key[32], msg[32], pub[33];
+    unsigned char sig[72], sig2[72];
+    int siglen, siglen2, publen;
+    secp256k1_presig_pool_t *pool, *pool2;
+    secp256k1_scalar_t k;
+    int i;
+
+    secp256k1_rand256(seed);
+    random_scalar_order_test(&k);
+    secp256k1_scalar_get_b32(key, &k);
+    publen = 33;
+    CHECK(secp256k1_ec_pubkey_create(ctx, pub, &publen, key, 1));
+    pool = secp256k1_presig_pool_create(5, seed);
+    pool2 = secp256k1_presig_pool_create(5, seed);
+
+    /* An empty pool cannot sign. */
+    secp256k1_rand256_test(msg);
+    siglen = 72;
+    CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool, msg, sig, &siglen, key) == 0);
+    CHECK(siglen == 0);
+
+    CHECK(secp256k1_presig_pool_refill(ctx, pool, NULL) == 5);
+    CHECK(secp256k1_presig_pool_refill(ctx, pool, NULL) == 0);
+    CHECK(secp256k1_presig_pool_refill(ctx, pool2, NULL) == 5);
+    CHECK(secp256k1_presig_pool_size(pool) == 5);
+
+    /* Each signature verifies and uses up one entry; the same seed gives the same nonces. */
+    for (i = 0; i < 3; i++) {
+        secp256k1_rand256_test(msg);
+        siglen = 72;
+        CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool, msg, sig, &siglen, key) == 1);
+        CHECK(secp256k1_ecdsa_verify(ctx, msg, sig, siglen, pub, publen) == 1);
+        CHECK(secp256k1_presig_pool_size(pool) == (size_t)(4 - i));
+        siglen2 = 72;
+        CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool2, msg, sig2, &siglen2, key) == 1);
+        CHECK(siglen == siglen2 && memcmp(sig, sig2, siglen) == 0);
+    }
+
+    /* An invalid key or a short buffer fails; only the latter spends an entry. */
+    memset(key, 0xFF, 32);
+    siglen = 72;
+    CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool, msg, sig, &siglen, key) == 0);
+    CHECK(siglen == 0);
+    CHECK(secp256k1_presig_pool_size(pool) == 2);
+    secp256k1_scalar_get_b32(key, &k);
+    siglen = 8;
+    CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool, msg, sig, &siglen, key) == 0);
+    CHECK(siglen == 0);
+    CHECK(secp256k1_presig_pool_size(pool) == 1);
+    siglen2 = 8;
+    CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool2, msg, sig2, &siglen2, key) == 0);
+
+    /* Mixing in new randomness makes the new nonces diverge; the one left over stays the same. */
+    secp256k1_rand256(seed);
+    CHECK(secp256k1_presig_pool_refill(ctx, pool, seed) == 4);
+    CHECK(secp256k1_presig_pool_refill(ctx, pool2, NULL) == 4);
+    for (i = 0; i < 5; i++) {
+        siglen = 72;
+        CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool, msg, sig, &siglen, key) == 1);
+        CHECK(secp256k1_ecdsa_verify(ctx, msg, sig, siglen, pub, publen) == 1);
+        siglen2 = 72;
+        CHECK(secp256k1_ecdsa_sign_with_pool(ctx, pool2, msg, sig2, &siglen2, key) == 1);
+        CHECK((siglen == siglen2 && memcmp(sig, sig2, siglen) == 0) == (i == 0));
+    }
+    CHECK(secp256k1_presig_pool_size(pool) == 0);
+
+    secp256k1_presig_pool_destroy(pool);
+    secp256k1_presig_pool_destroy(pool2);
+}
+
+void run_ecdsa_sign_batch(void) {
+    int i;
+    for (i = 0; i < count; i++) {
+        test_ecdsa_sign_batch();
+    }
+}
+
 int is_empty_compact_signature(const unsigned char *sig64) {
     static const unsigned char res[64] = {0};
     return memcmp(sig64, res, 64) == 0;
@@ -2462,6 +3260,10 @@ void test_rangeproof(void) {
     uint64_t minv;
     uint64_t maxv;
     int len;
+    int rings;
+    int npub;
+    int ecmults;
+    int explen;
     int i;
     int j;
     int k;
@@ -2473,6 +3275,8 @@ void test_rangeproof(void) {
             len = 5134;
             CHECK(secp256k1_rangeproof_sign(ctx, proof, &len, vmin, commit, blind, commit, 0, 0, v));
             CHECK(len <= 5134);
+            CHECK(secp256k1_rangeproof_rewind_check(ctx, commit, commit, proof, len));
+            CHECK(!secp256k1_rangeproof_rewind_check(ctx, blind, commit, proof, len));
             mlen = 4096;
             CHECK(secp256k1_rangeproof_rewind(ctx, blindout, &vout, message, &mlen, commit, &minv, &maxv, commit, proof, len));
             for (j = 0; j < mlen; j++) {
@@ -2543,6 +3347,19 @@ void test_rangeproof(void) {
         }
         CHECK(secp256k1_rangeproof_sign(ctx, proof, &len, vmin, commit, blind, commit, exp, min_bits, v));
         CHECK(len <= 5134);
+        CHECK(secp256k1_rangeproof_rewind_check(ctx, commit, commit, proof, len));
+        CHECK(secp256k1_rangeproof_info(ctx, &exp, &min_bits, &minv, &maxv, proof, len));
+        CHECK(secp256k1_rangeproof_verify_cost(ctx, &rings, &npub, &ecmults, &explen, proof, len));
+        CHECK(explen == len);
+        CHECK(ecmults == npub);
+        if (min_bits == 0) {
+            CHECK(rings == 1 && npub == 1);
+        } else {
+            CHECK(rings == (min_bits + 1) >> 1);
+            CHECK(npub == ((min_bits >> 1) << 2) + ((min_bits & 1) << 1));
+        }
+        CHECK(!secp256k1_rangeproof_verify_cost(ctx, &rings, &npub, &ecmults, &explen, proof, len - 1));
+        CHECK(explen == len);
         mlen = 4096;
         CHECK(secp256k1_rangeproof_rewind(ctx, blindout, &vout, message, &mlen, commit, &minv, &maxv, commit, proof, len));
         for (j = 0; j < mlen; j++) {
@@ -2569,6 +3386,236 @@ void test_rangeproof(void) {
     }
 }
 
+void test_rangeproof_varint(void) {
+    static const uint64_t testvs[8] = {0, 1, 127, 128, 16511, 16512, UINT64_MAX - 1, UINT64_MAX};
+    static const int testlens[8] = {1, 1, 1, 2, 2, 3, 10, 10};
+    unsigned char buf[11];
+    uint64_t v;
+    uint64_t vout;
+    int len;
+    int offset;
+    int i;
+    for (i = 0; i < 8 + count; i++) {
+        v = i < 8 ? testvs[i] : (uint64_t)secp256k1_rands64(0, UINT64_MAX >> (secp256k1_rand32() & 63));
+        len = secp256k1_rangeproof_varint_write(buf, v);
+        CHECK(i >= 8 || len == testlens[i]);
+        offset = 0;
+        CHECK(secp256k1_rangeproof_varint_read(&vout, buf, &offset, len));
+        CHECK(offset == len);
+        CHECK(vout == v);
+        offset = 0;
+        CHECK(!secp256k1_rangeproof_varint_read(&vout, buf, &offset, len - 1));
+    }
+    /* Overlong encodings overflow rather than wrap. */
+    memset(buf, 0xff, 11);
+    offset = 0;
+    CHECK(!secp256k1_rangeproof_varint_read(&vout, buf, &offset, 11));
+}
+
+void test_rangeproof_compact(void) {
+    unsigned char commit[33];
+    unsigned char proof[5134];
+    unsigned char proof2[5134];
+    unsigned char blind[32];
+    unsigned char blindout[32];
+    unsigned char tmp[10];
+    uint64_t v;
+    uint64_t vmin;
+    uint64_t vout;
+    uint64_t minv;
+    uint64_t maxv;
+    uint64_t minv2;
+    uint64_t maxv2;
+    int len;
+    int len2;
+    int i;
+    v = secp256k1_rands64(1, INT64_MAX);
+    vmin = secp256k1_rands64(1, v);
+    secp256k1_rand256(blind);
+    CHECK(secp256k1_pedersen_commit(ctx, commit, blind, v));
+    len = 5134;
+    CHECK(secp256k1_rangeproof_sign(ctx, proof, &len, vmin, commit, blind, commit, 0, 0, v));
+    len2 = 5134;
+    CHECK(secp256k1_rangeproof_sign_compact(ctx, proof2, &len2, vmin, commit, blind, commit, 0, 0, v));
+    CHECK((proof[0] & 128) == 0);
+    CHECK(proof2[0] == (proof[0] | 128));
+    CHECK(secp256k1_rangeproof_verify(ctx, &minv, &maxv, commit, proof, len));
+    CHECK(secp256k1_rangeproof_verify(ctx, &minv2, &maxv2, commit, proof2, len2));
+    CHECK(minv == minv2 && maxv == maxv2);
+    CHECK(len2 == len - 8 + secp256k1_rangeproof_varint_write(tmp, minv));
+    CHECK(secp256k1_rangeproof_rewind(ctx, blindout, &vout, NULL, NULL, commit, &minv2, &maxv2, commit, proof2, len2));
+    CHECK(memcmp(blindout, blind, 32) == 0);
+    CHECK(vout == v);
+    /* Flipping any header bit, including the compact flag, must invalidate the proof. */
+    for (i = 0; i < 8 * (len2 - len + 18); i++) {
+        proof2[i >> 3] ^= 1 << (i & 7);
+        CHECK(!secp256k1_rangeproof_verify(ctx, &minv2, &maxv2, commit, proof2, len2));
+        proof2[i >> 3] ^= 1 << (i & 7);
+    }
+    /* Without a min_value there is nothing to compact, so both encodings are identical. */
+    len = 5134;
+    CHECK(secp256k1_rangeproof_sign(ctx, proof, &len, 0, commit, blind, commit, 0, 0, v));
+    len2 = 5134;
+    CHECK(secp256k1_rangeproof_sign_compact(ctx, proof2, &len2, 0, commit, blind, commit, 0, 0, v));
+    CHECK(len == len2 && memcmp(proof, proof2, len) == 0);
+    proof2[0] |= 128;
+    CHECK(!secp256k1_rangeproof_info(ctx, &i, &len, &minv, &maxv, proof2, len2));
+}
+
+/* Runs the workers one after another, last first, so the early ones find their work already stolen. */
+static void test_executor_reverse(secp256k1_parallel_task_t task, void *arg, int nworkers, void *data) {
+    int i;
+    for (i = nworkers - 1; i >= 0; i--) {
+        task(arg, i);
+        (*(int *)data)++;
+    }
+}
+
+void test_rangeproof_scan(void) {
+    unsigned char commits[33 * 4];
+    unsigned char proofs[5134 * 4];
+    unsigned char blinds[32 * 4];
+    unsigned char nonces[32 * 3];
+    unsigned char blindsout[32 * 4];
+    unsigned char messages[4096 * 4];
+    const unsigned char *cptr[4];
+    const unsigned char *pptr[4];
+    const unsigned char *nptr[3];
+    uint64_t values[4];
+    uint64_t valuesout[4];
+    int plens[4];
+    int mlens[4];
+    int nonce_idx[4];
+    int calls = 0;
+    int i;
+    for (i = 0; i < 3; i++) {
+        secp256k1_rand256(&nonces[i * 32]);
+        nptr[i] = &nonces[i * 32];
+    }
+    for (i = 0; i < 4; i++) {
+        secp256k1_rand256(&blinds[i * 32]);
+        values[i] = secp256k1_rands64(0, INT64_MAX);
+        CHECK(secp256k1_pedersen_commit(ctx, &commits[i * 33], &blinds[i * 32], values[i]));
+        plens[i] = 5134;
+        /* Proof 3 uses a nonce which is not in the candidate set. */
+        CHECK(secp256k1_rangeproof_sign(ctx, &proofs[i * 5134], &plens[i], 0, &commits[i * 33], &blinds[i * 32],
+         i < 3 ? nptr[2 - i] : &blinds[i * 32], 0, 0, values[i]));
+        cptr[i] = &commits[i * 33];
+        pptr[i] = &proofs[i * 5134];
+    }
+    memset(blindsout, 0xAA, sizeof(blindsout));
+    memset(messages, 0xAA, sizeof(messages));
+    valuesout[3] = 7;
+    mlens[3] = 7;
+    CHECK(secp256k1_rangeproof_rewind_scan(ctx, nonce_idx, blindsout, valuesout, messages, mlens, nptr, 3, cptr, pptr, plens, 4, 3, NULL, NULL) == 3);
+    for (i = 0; i < 3; i++) {
+        CHECK(nonce_idx[i] == 2 - i);
+        CHECK(valuesout[i] == values[i]);
+        CHECK(memcmp(&blindsout[i * 32], &blinds[i * 32], 32) == 0);
+        CHECK(mlens[i] <= 4096);
+    }
+    /* The outputs of a proof that was not rewound are left alone. */
+    CHECK(nonce_idx[3] == -1);
+    CHECK(valuesout[3] == 7 && mlens[3] == 7);
+    for (i = 0; i < 32; i++) {
+        CHECK(blindsout[3 * 32 + i] == 0xAA);
+    }
+    for (i = 0; i < 4096; i++) {
+        CHECK(messages[3 * 4096 + i] == 0xAA);
+    }
+    CHECK(secp256k1_rangeproof_rewind_scan(ctx, nonce_idx, NULL, NULL, NULL, NULL, nptr, 1, cptr, pptr, plens, 4, 1, NULL, NULL) == 1);
+    CHECK(nonce_idx[0] == -1 && nonce_idx[1] == -1 && nonce_idx[2] == 0 && nonce_idx[3] == -1);
+    CHECK(secp256k1_rangeproof_rewind_scan(ctx, nonce_idx, NULL, NULL, NULL, NULL, nptr, 2, cptr, pptr, plens, 4, 2, test_executor_reverse, &calls) == 2);
+    CHECK(nonce_idx[0] == -1 && nonce_idx[1] == 1 && nonce_idx[2] == 0 && nonce_idx[3] == -1);
+#ifdef USE_PTHREADS
+    CHECK(calls == 2);
+#else
+    CHECK(calls == 0);
+#endif
+    CHECK(secp256k1_rangeproof_rewind_scan(ctx, nonce_idx, NULL, NULL, NULL, NULL, NULL, 0, cptr, pptr, plens, 4, 2, NULL, NULL) == 0);
+}
+
+void test_rangeproof_scratch(void) {
+    size_t size = secp256k1_rangeproof_scratch_size(ctx);
+    secp256k1_scratch_space_t *scratch = secp256k1_scratch_space_create(size + 64);
+    secp256k1_scratch_space_t *small = secp256k1_scratch_space_create(size / 2);
+    unsigned char commit[33];
+    unsigned char proof[5134];
+    unsigned char proof2[5134];
+    unsigned char blind[32];
+    unsigned char nonce[32];
+    unsigned char blindout[32];
+    unsigned char message[4096];
+    uint64_t v;
+    uint64_t vout;
+    uint64_t minv;
+    uint64_t maxv;
+    size_t checkpoint;
+    size_t j;
+    int len;
+    int len2;
+    int mlen;
+
+    /* The arena hands out cache-line multiples and refuses what does not fit; reset releases everything since a checkpoint. */
+    checkpoint = secp256k1_scratch_space_checkpoint(scratch);
+    CHECK(checkpoint == 0);
+    CHECK(secp256k1_scratch_alloc(scratch, 1) != NULL);
+    CHECK(secp256k1_scratch_space_checkpoint(scratch) == 64);
+    CHECK(secp256k1_scratch_alloc(scratch, size + 1) == NULL);
+    CHECK(secp256k1_scratch_alloc(scratch, size) != NULL);
+    CHECK(secp256k1_scratch_alloc(scratch, 1) == NULL);
+    secp256k1_scratch_space_reset(scratch, 64);
+    CHECK(secp256k1_scratch_space_checkpoint(scratch) == 64);
+    secp256k1_scratch_space_reset(scratch, checkpoint);
+
+    /* Proofs made through a scratch space match the ones made on the stack, and the space is returned afterwards. */
+    secp256k1_rand256(blind);
+    secp256k1_rand256(nonce);
+    v = secp256k1_rands64(0, INT64_MAX);
+    CHECK(secp256k1_pedersen_commit(ctx, commit, blind, v));
+    len = 5134;
+    CHECK(secp256k1_rangeproof_sign(ctx, proof, &len, 0, commit, blind, nonce, 0, 0, v));
+    len2 = 5134;
+    CHECK(secp256k1_rangeproof_sign_scratch(ctx, scratch, proof2, &len2, 0, commit, blind, nonce, 0, 0, v, 0));
+    CHECK(len2 == len && memcmp(proof, proof2, len) == 0);
+    CHECK(secp256k1_scratch_space_checkpoint(scratch) == 0);
+    len = 5134;
+    len2 = 5134;
+    CHECK(secp256k1_rangeproof_sign_compact(ctx, proof, &len, 1000, commit, blind, nonce, 0, 0, v));
+    CHECK(secp256k1_rangeproof_sign_scratch(ctx, scratch, proof2, &len2, 1000, commit, blind, nonce, 0, 0, v, 1));
+    CHECK(len2 == len && memcmp(proof, proof2, len) == 0);
+    CHECK(secp256k1_rangeproof_verify_scratch(ctx, scratch, &minv, &maxv, commit, proof2, len2));
+    CHECK(minv <= v && maxv >= v);
+    mlen = 4096;
+    CHECK(secp256k1_rangeproof_rewind_scratch(ctx, scratch, blindout, &vout, message, &mlen, nonce, &minv, &maxv, commit, proof2, len2));
+    CHECK(vout == v);
+    CHECK(memcmp(blindout, blind, 32) == 0);
+    CHECK(secp256k1_scratch_space_checkpoint(scratch) == 0);
+
+    /* Signing and rewinding wipe what they drew, so no secrets are left for the next user of the space. */
+    memset(scratch->data, 0xAA, scratch->max_size);
+    len2 = 5134;
+    CHECK(secp256k1_rangeproof_sign_scratch(ctx, scratch, proof2, &len2, 0, commit, blind, nonce, 0, 0, v, 0));
+    for (j = 0; j < sizeof(secp256k1_rangeproof_sign_frame_t); j++) {
+        CHECK(scratch->data[j] == 0);
+    }
+    memset(scratch->data, 0xAA, scratch->max_size);
+    mlen = 4096;
+    CHECK(secp256k1_rangeproof_rewind_scratch(ctx, scratch, blindout, &vout, message, &mlen, nonce, &minv, &maxv, commit, proof2, len2));
+    for (j = 0; j < sizeof(secp256k1_rangeproof_verify_frame_t); j++) {
+        CHECK(scratch->data[j] == 0);
+    }
+
+    /* Too little scratch space makes them fail rather than overrun. */
+    len2 = 5134;
+    CHECK(!secp256k1_rangeproof_sign_scratch(ctx, small, proof2, &len2, 0, commit, blind, nonce, 0, 0, v, 0));
+    CHECK(!secp256k1_rangeproof_rewind_scratch(ctx, small, blindout, &vout, message, &mlen, nonce, &minv, &maxv, commit, proof, len));
+    CHECK(secp256k1_scratch_space_checkpoint(small) == 0);
+
+    secp256k1_scratch_space_destroy(scratch);
+    secp256k1_scratch_space_destroy(small);
+}
+
 void run_borromean(void) {
     int i;
     for (i = 0; i < 10*count; i++) {
@@ -2577,7 +3624,256 @@ void run_borromean(void) {
 }
 
 void run_rangeproof(void) {
+    int i;
     test_rangeproof();
+    test_rangeproof_varint();
+    for (i = 0; i < 4; i++) {
+        test_rangeproof_compact();
+    }
+    test_rangeproof_scan();
+    test_rangeproof_scratch();
+}
+
+void run_verify_batch_parallel(void) {
+    secp256k1_verify_job_t jobs[24];
+    int expect[24];
+    unsigned char msg[16][32];
+    unsigned char sig[16][72];
+    int siglen[16];
+    unsigned char pub[16][33];
+    int publen[16];
+    unsigned char key[32];
+    unsigned char blind[32];
+    unsigned char nonce[32];
+    unsigned char commit[2][33];
+    const unsigned char *cptr[2];
+    unsigned char proof[2][5134];
+    int plen[2];
+    uint64_t v[2];
+    uint64_t minv[2];
+    uint64_t maxv[2];
+    int nthreads[4] = {1, 3, 8, 64};
+    int all;
+    int calls;
+    int i, j;
+
+    /* 16 signatures of which every fourth is for the wrong message, and in every eight one key and one
+     * signature are unparsable. */
+    for (i = 0; i < 16; i++) {
+        secp256k1_scalar_t k;
+        random_scalar_order_test(&k);
+        secp256k1_scalar_get_b32(key, &k);
+        secp256k1_rand256_test(msg[i]);
+        siglen[i] = 72;
+        CHECK(secp256k1_ecdsa_sign(ctx, msg[i], sig[i], &siglen[i], key, NULL, NULL));
+        publen[i] = 33;
+        CHECK(secp256k1_ec_pubkey_create(ctx, pub[i], &publen[i], key, 1));
+        if (i % 4 == 3) {
+            msg[i][0] ^= 1;
+        }
+        if (i % 8 == 7) {
+            pub[i][0] = 5;
+        }
+        if (i % 8 == 2) {
+            siglen[i] = 5;
+        }
+        jobs[i].type = SECP256K1_VERIFY_JOB_ECDSA;
+        jobs[i].u.ecdsa.msg32 = msg[i];
+        jobs[i].u.ecdsa.sig = sig[i];
+        jobs[i].u.ecdsa.siglen = siglen[i];
+        jobs[i].u.ecdsa.pubkey = pub[i];
+        jobs[i].u.ecdsa.pubkeylen = publen[i];
+        expect[i] = secp256k1_ecdsa_verify(ctx, msg[i], sig[i], siglen[i], pub[i], publen[i]);
+    }
+    CHECK(expect[2] == -2 && expect[7] == -1);
+
+    /* Two range proofs, the second corrupted, and tallies over their commitments. */
+    secp256k1_rand256(blind);
+    secp256k1_rand256(nonce);
+    for (i = 0; i < 2; i++) {
+        v[i] = secp256k1_rands64(0, 1000000);
+        CHECK(secp256k1_pedersen_commit(ctx, commit[i], blind, v[i]));
+        cptr[i] = commit[i];
+        plen[i] = 5134;
+        CHECK(secp256k1_rangeproof_sign(ctx, proof[i], &plen[i], 0, commit[i], blind, nonce, 0, 0, v[i]));
+        jobs[16 + i].type = SECP256K1_VERIFY_JOB_RANGEPROOF;
+        jobs[16 + i].u.rangeproof.commit = commit[i];
+        jobs[16 + i].u.rangeproof.proof = proof[i];
+        jobs[16 + i].u.rangeproof.plen = plen[i];
+    }
+    proof[1][plen[1] / 2] ^= 1;
+    for (i = 0; i < 2; i++) {
+        expect[16 + i] = secp256k1_rangeproof_verify(ctx, &minv[i], &maxv[i], commit[i], proof[i], plen[i]);
+    }
+    CHECK(expect[16] == 1 && expect[17] == 0);
+    for (i = 0; i < 4; i++) {
+        jobs[18 + i].type = SECP256K1_VERIFY_JOB_TALLY;
+        jobs[18 + i].u.tally.commits = &cptr[0];
+        jobs[18 + i].u.tally.pcnt = 1;
+        jobs[18 + i].u.tally.ncommits = &cptr[1];
+        jobs[18 + i].u.tally.ncnt = 1;
+        jobs[18 + i].u.tally.excess = (int64_t)v[0] - (int64_t)v[1] + (i & 1);
+        expect[18 + i] = (i & 1) == 0;
+    }
+    /* Jobs of unknown types fail. */
+    for (i = 22; i < 24; i++) {
+        jobs[i].type = 42 * (i - 22);
+        expect[i] = 0;
+    }
+
+    for (j = 0; j < 5; j++) {
+        for (i = 0; i < 24; i++) {
+            jobs[i].result = 7;
+        }
+        if (j < 4) {
+            all = secp256k1_verify_batch_parallel(ctx, jobs, 24, nthreads[j], NULL, NULL);
+        } else {
+            calls = 0;
+            all = secp256k1_verify_batch_parallel(ctx, jobs, 24, 5, test_executor_reverse, &calls);
+#ifdef USE_PTHREADS
+            CHECK(calls == 5);
+#else
+            CHECK(calls == 0);
+#endif
+        }
+        CHECK(all == 0);
+        for (i = 0; i < 24; i++) {
+            CHECK(jobs[i].result == expect[i]);
+        }
+        CHECK(jobs[16].u.rangeproof.min_value == minv[0] && jobs[16].u.rangeproof.max_value == maxv[0]);
+    }
+
+    /* A batch of only valid jobs passes as a whole, and an empty one trivially does. */
+    CHECK(secp256k1_verify_batch_parallel(ctx, jobs, 2, 2, NULL, NULL) == 1);
+    CHECK(jobs[0].result == 1 && jobs[1].result == 1);
+    CHECK(secp256k1_verify_batch_parallel(ctx, NULL, 0, 4, NULL, NULL) == 1);
+}
+
+typedef struct {
+    secp256k1_verify_job_t *jobs;
+    int calls[12];
+} test_verifier_calls_t;
+
+static void test_verifier_callback(secp256k1_verify_job_t *job, void *data) {
+    test_verifier_calls_t *calls = (test_verifier_calls_t *)data;
+    /* Every job comes back exactly once, so its counter needs no lock. */
+    calls->calls[job - calls->jobs]++;
+}
+
+void run_verifier_tests(void) {
+    secp256k1_verify_job_t jobs[12];
+    secp256k1_verify_job_t extra;
+    secp256k1_verify_job_t *done[12];
+    int expect[12];
+    int seen[12];
+    unsigned char msg[10][32];
+    unsigned char sig[10][72];
+    unsigned char pub[10][33];
+    unsigned char key[32];
+    unsigned char blind[32];
+    unsigned char nonce[32];
+    unsigned char commit[33];
+    const unsigned char *cptr[1];
+    unsigned char proof[5134];
+    test_verifier_calls_t calls;
+    secp256k1_verifier_t *verifier;
+    uint64_t v;
+    size_t collected;
+    int siglen;
+    int publen;
+    int plen;
+    int i;
+
+    /* Ten signatures, every third for the wrong message, a range proof and a tally that does not balance. */
+    for (i = 0; i < 10; i++) {
+        secp256k1_scalar_t k;
+        random_scalar_order_test(&k);
+        secp256k1_scalar_get_b32(key, &k);
+        secp256k1_rand256_test(msg[i]);
+        siglen = 72;
+        CHECK(secp256k1_ecdsa_sign(ctx, msg[i], sig[i], &siglen, key, NULL, NULL));
+        publen = 33;
+        CHECK(secp256k1_ec_pubkey_create(ctx, pub[i], &publen, key, 1));
+        msg[i][31] ^= i % 3 == 2;
+        jobs[i].type = SECP256K1_VERIFY_JOB_ECDSA;
+        jobs[i].u.ecdsa.msg32 = msg[i];
+        jobs[i].u.ecdsa.sig = sig[i];
+        jobs[i].u.ecdsa.siglen = siglen;
+        jobs[i].u.ecdsa.pubkey = pub[i];
+        jobs[i].u.ecdsa.pubkeylen = publen;
+        expect[i] = i % 3 != 2;
+    }
+    secp256k1_rand256(blind);
+    secp256k1_rand256(nonce);
+    v = secp256k1_rands64(0, 1000000);
+    CHECK(secp256k1_pedersen_commit(ctx, commit, blind, v));
+    cptr[0] = commit;
+    plen = 5134;
+    CHECK(secp256k1_rangeproof_sign(ctx, proof, &plen, 0, commit, blind, nonce, 0, 0, v));
+    jobs[10].type = SECP256K1_VERIFY_JOB_RANGEPROOF;
+    jobs[10].u.rangeproof.commit = commit;
+    jobs[10].u.rangeproof.proof = proof;
+    jobs[10].u.rangeproof.plen = plen;
+    expect[10] = 1;
+    jobs[11].type = SECP256K1_VERIFY_JOB_TALLY;
+    jobs[11].u.tally.commits = cptr;
+    jobs[11].u.tally.pcnt = 1;
+    jobs[11].u.tally.ncommits = NULL;
+    jobs[11].u.tally.ncnt = 0;
+    jobs[11].u.tally.excess = (int64_t)v + 1;
+    expect[11] = 0;
+    extra = jobs[0];
+
+    /* Polled completions: every job comes back once, and submissions beyond capacity are refused until polled. */
+    verifier = secp256k1_verifier_create(ctx, 3, 12, NULL, NULL);
+    CHECK(verifier != NULL);
+#ifdef HAVE_SYS_EVENTFD_H
+    CHECK(secp256k1_verifier_fd(verifier) >= 0);
+#else
+    CHECK(secp256k1_verifier_fd(verifier) == -1);
+#endif
+    for (i = 0; i < 12; i++) {
+        jobs[i].result = 7;
+        seen[i] = 0;
+        CHECK(secp256k1_verifier_submit(verifier, &jobs[i]));
+    }
+    CHECK(!secp256k1_verifier_submit(verifier, &extra));
+    collected = 0;
+    while (collected < 12) {
+        /* Collect in small bites, so some completions are left behind for the next call. */
+        collected += secp256k1_verifier_poll(verifier, &done[collected], 5);
+    }
+    CHECK(secp256k1_verifier_poll(verifier, done, 12) == 0);
+    for (i = 0; i < 12; i++) {
+        seen[done[i] - jobs]++;
+    }
+    for (i = 0; i < 12; i++) {
+        CHECK(seen[i] == 1);
+        CHECK(jobs[i].result == expect[i]);
+    }
+    CHECK(jobs[10].u.rangeproof.min_value <= v && jobs[10].u.rangeproof.max_value >= v);
+    CHECK(secp256k1_verifier_submit(verifier, &extra));
+    CHECK(secp256k1_verifier_submit(verifier, &jobs[0]));
+    /* Destroying waits for jobs in flight and drops their unpolled completions. */
+    secp256k1_verifier_destroy(verifier);
+    CHECK(extra.result == 1 && jobs[0].result == 1);
+
+    /* Callback completions. */
+    calls.jobs = jobs;
+    memset(calls.calls, 0, sizeof(calls.calls));
+    verifier = secp256k1_verifier_create(ctx, 2, 12, test_verifier_callback, &calls);
+    CHECK(verifier != NULL);
+    CHECK(secp256k1_verifier_fd(verifier) == -1);
+    for (i = 0; i < 12; i++) {
+        jobs[i].result = 7;
+        CHECK(secp256k1_verifier_submit(verifier, &jobs[i]));
+    }
+    CHECK(secp256k1_verifier_poll(verifier, done, 12) == 0);
+    secp256k1_verifier_destroy(verifier);
+    for (i = 0; i < 12; i++) {
+        CHECK(calls.calls[i] == 1);
+        CHECK(jobs[i].result == expect[i]);
+    }
 }
 
 
@@ -2626,6 +3922,7 @@ int main(int argc, char **argv) {
 
     /* initialize */
     run_context_tests();
+    run_context_preallocated_tests();
     ctx = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_COMMIT | SECP256K1_CONTEXT_RANGEPROOF);
 
     if (secp256k1_rand32() & 1) {
@@ -2638,8 +3935,12 @@ int main(int argc, char **argv) {
     run_pedersen();
     run_borromean();
     run_rangeproof();
+    run_verify_batch_parallel();
+    run_verifier_tests();
 
     run_sha256_tests();
+    run_sha256_transform_tests();
+    run_sha256_multi_tests();
     run_hmac_sha256_tests();
     run_rfc6979_hmac_sha256_tests();
 
@@ -2650,11 +3951,20 @@ int main(int argc, char **argv) {
 
     /* scalar tests */
     run_scalar_tests();
+#if defined(USE_ASM_X86_64) && defined(USE_SCALAR_4X64)
+    run_scalar_asm();
+#endif
 
     /* field tests */
+#if defined(USE_ASM_X86_64) && defined(USE_FIELD_5X52)
+    run_field_asm();
+#endif
+    run_field_4way();
     run_field_inv();
     run_field_inv_var();
     run_field_inv_all_var();
+    run_scalar_inv_all_var();
+    run_inverse_tests();
     run_field_misc();
     run_field_convert();
     run_sqr();
@@ -2662,13 +3972,16 @@ int main(int argc, char **argv) {
 
     /* group tests */
     run_ge();
+    run_group_4way();
 
     /* ecmult tests */
     run_wnaf();
     run_point_times_order();
     run_ecmult_chain();
     run_ecmult_constants();
+    run_ecmult_4way();
     run_ecmult_gen_blind();
+    run_ecmult_gen_table_lookup();
 
     /* ecdh tests */
     run_ecdh_tests();
@@ -2677,6 +3990,9 @@ int main(int argc, char **argv) {
     /* ecdsa tests */
     run_random_pubkeys();
     run_ecdsa_sign_verify();
+    run_ecdsa_batch();
+    run_ecdsa_sign_batch();
+    run_presig_pool();
     run_ecdsa_end_to_end();
     run_ecdsa_edge_cases();
 #ifdef ENABLE_OPENSSL_TESTS
@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <limits.h>
 #include <stdio.h>
 
@@ -68,6 +69,46 @@ static SECP256K1_INLINE void *checked_malloc(size_t size) {
     return ret;
 }
 
+/* Like checked_malloc, but the result is aligned to align bytes (a power of two). The slack this needs is
+ * never touched, so for large blocks it only costs address space. Release with aligned_free. */
+static SECP256K1_INLINE void *checked_aligned_malloc(size_t size, size_t align) {
+    unsigned char *base = (unsigned char *)checked_malloc(size + align + sizeof(void *));
+    unsigned char *ret = base + sizeof(void *);
+    ret += (align - ((size_t)ret & (align - 1))) & (align - 1);
+    memcpy(ret - sizeof(void *), &base, sizeof(void *));
+    return ret;
+}
+
+static SECP256K1_INLINE void aligned_free(void *ptr) {
+    void *base;
+    if (ptr == NULL) {
+        return;
+    }
+    memcpy(&base, (unsigned char *)ptr - sizeof(void *), sizeof(void *));
+    free(base);
+}
+
+/* Round a size up to a whole number of 64-byte cache lines, so that tables carved out of a shared block
+ * with manual_alloc stay aligned. */
+#define ROUND_TO_ALIGN(size) (((size) + 63) & ~(size_t)63)
+
+/* Carve size bytes off the front of the block *prealloc points into, and advance it past them. */
+static SECP256K1_INLINE void *manual_alloc(void **prealloc, size_t size) {
+    void *ret;
+    VERIFY_CHECK(prealloc != NULL);
+    VERIFY_CHECK(*prealloc != NULL);
+    ret = *prealloc;
+    *prealloc = (unsigned char *)*prealloc + ROUND_TO_ALIGN(size);
+    return ret;
+}
+
+/* Hint that the cache line holding p will be read soon. */
+#if SECP256K1_GNUC_PREREQ(3,1)
+# define SECP256K1_PREFETCH(p) __builtin_prefetch((p))
+#else
+# define SECP256K1_PREFETCH(p) ((void)(p))
+#endif
+
 /* Macro for restrict, when available and not in a VERIFY build. */
 #if defined(SECP256K1_BUILD) && defined(VERIFY)
 # define SECP256K1_RESTRICT
@@ -100,7 +141,42 @@ static SECP256K1_INLINE void *checked_malloc(size_t size) {
 #  define SECP256K1_GNUC_EXT
 # endif
 SECP256K1_GNUC_EXT typedef unsigned __int128 uint128_t;
+SECP256K1_GNUC_EXT typedef __int128 int128_t;
+#endif
+
+/* Determine the number of trailing zero bits in a (non-zero) 32-bit x. Not constant time. */
+static SECP256K1_INLINE int secp256k1_ctz32_var(uint32_t x) {
+    VERIFY_CHECK(x != 0);
+#if SECP256K1_GNUC_PREREQ(3,4)
+    return __builtin_ctz(x);
+#else
+    {
+        int r = 0;
+        while ((x & 1) == 0) {
+            x >>= 1;
+            r++;
+        }
+        return r;
+    }
 #endif
+}
+
+/* Determine the number of trailing zero bits in a (non-zero) 64-bit x. Not constant time. */
+static SECP256K1_INLINE int secp256k1_ctz64_var(uint64_t x) {
+    VERIFY_CHECK(x != 0);
+#if SECP256K1_GNUC_PREREQ(3,4)
+    return __builtin_ctzll(x);
+#else
+    {
+        int r = 0;
+        while ((x & 1) == 0) {
+            x >>= 1;
+            r++;
+        }
+        return r;
+    }
+#endif
+}
 
 /* Extract the sign of an int64, take the abs and return a uint64, constant time. */
 SECP256K1_INLINE static int secp256k1_sign_and_abs64(uint64_t *out, int64_t in) {